@@ -0,0 +1,477 @@
+#include "header/cpu/ahci.h"
+#include "header/cpu/interrupt.h"
+#include "header/cpu/paging.h"
+#include "header/cpu/pci.h"
+#include "header/stdlib/string.h"
+
+static struct AHCIPortState ahci_state = {
+    .hba = NULL,
+    .port = NULL,
+    .slot_count = 1,
+    .ncq = false,
+    .issued = 0,
+    .batch = false,
+    .irq = BLOCK_DEVICE_IRQ_NONE,
+    .irq_enabled = false,
+    .error = false,
+    .block_count = 0,
+};
+
+// Command list, received FIS, command table, dan bounce buffer berada di image kernel, physical = virtual - KERNEL_VIRTUAL_BASE
+static struct AHCICommandHeader ahci_command_list[AHCI_SLOT_COUNT] __attribute__((aligned(AHCI_SLOT_COUNT * sizeof(struct AHCICommandHeader))));
+static uint8_t ahci_received_fis[AHCI_RECEIVED_FIS_SIZE] __attribute__((aligned(AHCI_RECEIVED_FIS_SIZE)));
+static struct AHCICommandTable ahci_command_table[AHCI_SLOT_COUNT] __attribute__((aligned(128)));
+static uint8_t ahci_bounce_buffer[AHCI_BOUNCE_BLOCK_COUNT * BLOCK_SIZE] __attribute__((aligned(BLOCK_SIZE)));
+
+// Physical address memory di image kernel
+static uint32_t ahci_physical(const void *ptr)
+{
+    return (uint32_t)ptr - KERNEL_VIRTUAL_BASE;
+}
+
+static uint32_t ahci_hba_read(uint32_t reg)
+{
+    return *(volatile uint32_t *)(ahci_state.hba + reg);
+}
+
+static void ahci_hba_write(uint32_t reg, uint32_t value)
+{
+    *(volatile uint32_t *)(ahci_state.hba + reg) = value;
+}
+
+static uint32_t ahci_port_read(uint32_t reg)
+{
+    return *(volatile uint32_t *)(ahci_state.port + reg);
+}
+
+static void ahci_port_write(uint32_t reg, uint32_t value)
+{
+    // Command list & command table harus sudah tertulis sebelum register port disentuh
+    __asm__ volatile("" ::: "memory");
+    *(volatile uint32_t *)(ahci_state.port + reg) = value;
+}
+
+// Slot yang masih dikerjakan HBA / drive
+static uint32_t ahci_active(void)
+{
+    return ahci_port_read(AHCI_PORT_SACT) | ahci_port_read(AHCI_PORT_CI);
+}
+
+// Menghentikan command list engine dan FIS receive port
+static void ahci_port_stop(void)
+{
+    ahci_port_write(AHCI_PORT_CMD, ahci_port_read(AHCI_PORT_CMD) & ~AHCI_PORT_CMD_ST);
+    while (ahci_port_read(AHCI_PORT_CMD) & AHCI_PORT_CMD_CR)
+        ;
+    ahci_port_write(AHCI_PORT_CMD, ahci_port_read(AHCI_PORT_CMD) & ~AHCI_PORT_CMD_FRE);
+    while (ahci_port_read(AHCI_PORT_CMD) & AHCI_PORT_CMD_FR)
+        ;
+}
+
+// Menjalankan port. TFD baru valid setelah FIS receive aktif, ST hanya boleh di-set ketika drive tidak sibuk
+static void ahci_port_start(void)
+{
+    ahci_port_write(AHCI_PORT_CMD, ahci_port_read(AHCI_PORT_CMD) | AHCI_PORT_CMD_FRE);
+    while (ahci_port_read(AHCI_PORT_TFD) & (ATA_STATUS_BSY | ATA_STATUS_DRQ))
+        ;
+    ahci_port_write(AHCI_PORT_CMD, ahci_port_read(AHCI_PORT_CMD) | AHCI_PORT_CMD_ST);
+}
+
+// Restart port setelah task file error, seluruh command di port dibatalkan
+static void ahci_port_restart(void)
+{
+    ahci_port_stop();
+    ahci_port_write(AHCI_PORT_SERR, 0xFFFFFFFF);
+    ahci_port_write(AHCI_PORT_IS, 0xFFFFFFFF);
+    ahci_state.error = false;
+    ahci_state.issued = 0;
+    ahci_port_start();
+}
+
+// Mengisi command FIS slot dari ahci_state.command lalu menyerahkannya ke HBA
+static void ahci_issue(uint8_t slot, uint8_t ata_command, bool queued)
+{
+    struct AHCICommand *command = &ahci_state.command[slot];
+    struct AHCIRegisterFIS *fis = (struct AHCIRegisterFIS *)ahci_command_table[slot].command_fis;
+    uint16_t block_count = (uint16_t)command->block_count; // 65536 overflow menjadi 0 = 65536 blok
+
+    memset(fis, 0, sizeof(struct AHCIRegisterFIS));
+    fis->type = AHCI_FIS_TYPE_REG_H2D;
+    fis->flag = AHCI_FIS_COMMAND;
+    fis->command = ata_command;
+    fis->device = AHCI_DEVICE_LBA;
+    fis->lba_low[0] = (uint8_t)command->logical_block_address;
+    fis->lba_low[1] = (uint8_t)(command->logical_block_address >> 8);
+    fis->lba_low[2] = (uint8_t)(command->logical_block_address >> 16);
+    fis->lba_high[0] = (uint8_t)(command->logical_block_address >> 24);
+    if (queued)
+    {
+        // FPDMA QUEUED: jumlah blok di register feature, tag NCQ di bit 7:3 register count
+        fis->feature_low = (uint8_t)block_count;
+        fis->feature_high = (uint8_t)(block_count >> 8);
+        fis->count = (uint16_t)slot << 3;
+    }
+    else
+        fis->count = block_count;
+
+    ahci_command_list[slot].flag = AHCI_COMMAND_FIS_DWORD_COUNT | (command->write ? AHCI_COMMAND_HEADER_WRITE : 0);
+    ahci_command_list[slot].prd_byte_count = 0;
+
+    ahci_state.issued |= 1u << slot;
+    if (queued)
+        ahci_port_write(AHCI_PORT_SACT, 1u << slot);
+    ahci_port_write(AHCI_PORT_CI, 1u << slot);
+}
+
+// Menunggu slot pada mask selesai (semua jika all, minimal satu jika tidak), false jika terjadi task file error
+static bool ahci_wait_slot(uint32_t mask, bool all)
+{
+    uint32_t eflags;
+    __asm__ volatile("pushf; pop %0; cli" : "=r"(eflags) : /* <Empty> */ : "memory");
+    while (!ahci_state.error)
+    {
+        uint32_t active = ahci_active() & mask;
+        if (all ? active == 0 : active != mask)
+            break;
+        if (ahci_state.irq_enabled)
+            // sti baru berlaku setelah instruksi berikutnya, sehingga tidak ada IRQ yang terlewat sebelum hlt
+            __asm__ volatile("sti; hlt; cli" ::: "memory");
+        else if (ahci_port_read(AHCI_PORT_IS) & AHCI_PORT_IS_TFES)
+            ahci_state.error = true;
+    }
+    if (eflags & EFLAGS_INTERRUPT_FLAG)
+        __asm__ volatile("sti");
+
+    if (ahci_state.error)
+        return false;
+    ahci_state.issued &= ahci_active();
+    return true;
+}
+
+// Task file error: port di-restart lalu command yang belum selesai diulang satu per satu tanpa NCQ
+static void ahci_recover(void)
+{
+    uint32_t pending = ahci_state.issued & ahci_active();
+    ahci_port_restart();
+    ahci_state.ncq = false;
+    for (uint8_t slot = 0; slot < AHCI_SLOT_COUNT; slot++)
+    {
+        if (!(pending & (1u << slot)))
+            continue;
+        ahci_issue(slot, ahci_state.command[slot].write ? ATA_COMMAND_WRITE_DMA_EXT : ATA_COMMAND_READ_DMA_EXT, false);
+        // Command yang tetap gagal ditinggalkan, sama seperti jalur PIO yang tidak melaporkan error
+        if (!ahci_wait_slot(1u << slot, true))
+            ahci_port_restart();
+    }
+}
+
+// Menunggu slot pada mask selesai, error dipulihkan dengan ahci_recover()
+static void ahci_wait(uint32_t mask, bool all)
+{
+    if (!ahci_wait_slot(mask, all))
+        ahci_recover();
+}
+
+// Slot kosong pertama, menunggu salah satu command selesai jika semua slot terpakai
+static uint8_t ahci_slot_allocate(void)
+{
+    uint32_t all_slot = ahci_state.slot_count == AHCI_SLOT_COUNT ? 0xFFFFFFFF : (1u << ahci_state.slot_count) - 1;
+    ahci_state.issued &= ahci_active();
+    if ((ahci_state.issued & all_slot) == all_slot)
+        ahci_wait(all_slot, false);
+
+    uint8_t slot = 0;
+    while (ahci_state.issued & (1u << slot))
+        slot++;
+    return slot;
+}
+
+/**
+ * Menambahkan entry PRDT slot yang langsung menunjuk memory, dipecah pada batas page 4 MiB.
+ * Mengembalikan jumlah blok yang tercakup (bisa lebih kecil dari block_count jika PRDT penuh),
+ * 0 jika memory tidak bisa di-DMA langsung (tidak ter-mapping atau tidak 2-byte aligned)
+ */
+static uint32_t ahci_append_prd(uint8_t slot, const void *ptr, uint32_t block_count, uint16_t *prd_count)
+{
+    struct AHCIPhysicalRegionDescriptor *prdt = ahci_command_table[slot].prdt;
+    uint32_t virtual_addr = (uint32_t)ptr;
+    uint32_t remaining = block_count * BLOCK_SIZE;
+    uint32_t covered = 0;
+    uint16_t first_entry = *prd_count;
+    if (virtual_addr & 1)
+        return 0;
+
+    while (remaining > 0 && *prd_count < AHCI_PRDT_ENTRY_COUNT)
+    {
+        uint32_t physical_addr;
+        if (!paging_virtual_to_physical(&_paging_kernel_page_directory, (void *)virtual_addr, &physical_addr))
+            break;
+
+        // Satu page frame 4 MiB sama dengan batas ukuran entry PRDT
+        uint32_t length = remaining;
+        uint32_t to_page = PAGE_FRAME_SIZE - (virtual_addr & (PAGE_FRAME_SIZE - 1));
+        if (length > to_page)
+            length = to_page;
+
+        prdt[*prd_count].data_address = physical_addr;
+        prdt[*prd_count].data_address_upper = 0;
+        prdt[*prd_count].reserved = 0;
+        prdt[*prd_count].byte_count = length - 1;
+        (*prd_count)++;
+        virtual_addr += length;
+        remaining -= length;
+        covered += length;
+    }
+
+    // Total PRDT harus kelipatan BLOCK_SIZE, potong entry terakhir region ini jika perlu
+    uint32_t excess = covered % BLOCK_SIZE;
+    covered -= excess;
+    while (excess > 0 && *prd_count > first_entry)
+    {
+        struct AHCIPhysicalRegionDescriptor *last = &prdt[*prd_count - 1];
+        uint32_t length = last->byte_count + 1;
+        if (length > excess)
+        {
+            last->byte_count = length - excess - 1;
+            excess = 0;
+        }
+        else
+        {
+            excess -= length;
+            (*prd_count)--;
+        }
+    }
+    return covered / BLOCK_SIZE;
+}
+
+// Menyerahkan read / write slot yang PRDT-nya sudah diisi, NCQ jika aktif
+static void ahci_submit(uint8_t slot, uint32_t logical_block_address, uint32_t block_count, bool write, uint16_t prd_count)
+{
+    ahci_state.command[slot].logical_block_address = logical_block_address;
+    ahci_state.command[slot].block_count = block_count;
+    ahci_state.command[slot].write = write;
+    ahci_command_list[slot].prdt_length = prd_count;
+
+    uint8_t ata_command;
+    if (ahci_state.ncq)
+        ata_command = write ? ATA_COMMAND_WRITE_FPDMA_QUEUED : ATA_COMMAND_READ_FPDMA_QUEUED;
+    else
+        ata_command = write ? ATA_COMMAND_WRITE_DMA_EXT : ATA_COMMAND_READ_DMA_EXT;
+    ahci_issue(slot, ata_command, ahci_state.ncq);
+}
+
+// Transfer melalui bounce buffer untuk memory yang tidak bisa di-DMA langsung, menunggu sampai selesai
+static uint32_t ahci_bounce(uint8_t slot, const struct BlockSegment *segment, uint32_t index, uint32_t offset,
+                            uint32_t logical_block_address, uint32_t block_count, bool write)
+{
+    if (block_count > AHCI_BOUNCE_BLOCK_COUNT)
+        block_count = AHCI_BOUNCE_BLOCK_COUNT;
+    if (write)
+        block_segment_copy(segment, index, offset, ahci_bounce_buffer, block_count, true);
+
+    uint16_t prd_count = 0;
+    ahci_append_prd(slot, ahci_bounce_buffer, block_count, &prd_count);
+    ahci_submit(slot, logical_block_address, block_count, write, prd_count);
+    ahci_wait(1u << slot, true);
+
+    if (!write)
+        block_segment_copy(segment, index, offset, ahci_bounce_buffer, block_count, false);
+    return block_count;
+}
+
+// Transfer daftar segment ke / dari LBA berurutan, satu command per slot tanpa menunggu command sebelumnya
+static void ahci_rw(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address, bool write)
+{
+    uint32_t block_count = 0;
+    for (uint32_t i = 0; i < segment_count; i++)
+        block_count += segment[i].block_count;
+
+    uint32_t index = 0;
+    uint32_t offset = 0;
+    while (block_count > 0)
+    {
+        uint32_t count = block_count < ATA_LBA48_MAX_BLOCK_COUNT ? block_count : ATA_LBA48_MAX_BLOCK_COUNT;
+        uint8_t slot = ahci_slot_allocate();
+
+        // Setiap segment menjadi entry PRDT, berhenti jika PRDT penuh atau memory tidak bisa di-DMA
+        uint16_t prd_count = 0;
+        uint32_t transferred = 0;
+        uint32_t prd_index = index;
+        uint32_t prd_offset = offset;
+        while (transferred < count)
+        {
+            uint8_t *ptr = block_segment_pointer(segment, &prd_index, &prd_offset);
+            uint32_t want = segment[prd_index].block_count - prd_offset;
+            if (want > count - transferred)
+                want = count - transferred;
+            uint32_t covered = ahci_append_prd(slot, ptr, want, &prd_count);
+            transferred += covered;
+            if (covered < want)
+                break;
+            prd_offset += covered;
+        }
+
+        if (transferred > 0)
+            ahci_submit(slot, logical_block_address, transferred, write, prd_count);
+        else
+            transferred = ahci_bounce(slot, segment, index, offset, logical_block_address, count, write);
+
+        block_segment_advance(segment, &index, &offset, transferred);
+        logical_block_address += transferred;
+        block_count -= transferred;
+    }
+
+    // Di luar batch, caller boleh langsung memakai / menimpa memory segment
+    if (!ahci_state.batch)
+        ahci_wait(ahci_state.issued, true);
+}
+
+// Command non-queued tanpa / dengan satu blok data (IDENTIFY, FLUSH CACHE), seluruh command lain diselesaikan dulu
+static bool ahci_execute(uint8_t ata_command, void *buffer)
+{
+    ahci_wait(ahci_state.issued, true);
+
+    uint16_t prd_count = 0;
+    if (buffer != NULL)
+        ahci_append_prd(0, buffer, 1, &prd_count);
+    ahci_state.command[0].logical_block_address = 0;
+    ahci_state.command[0].block_count = 0;
+    ahci_state.command[0].write = false;
+    ahci_command_list[0].prdt_length = prd_count;
+    ahci_issue(0, ata_command, false);
+
+    if (ahci_wait_slot(1, true))
+        return true;
+    ahci_port_restart();
+    return false;
+}
+
+static void ahci_read(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    ahci_rw(segment, segment_count, logical_block_address, false);
+}
+
+static void ahci_write(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    ahci_rw(segment, segment_count, logical_block_address, true);
+}
+
+static void ahci_flush(void)
+{
+    ahci_execute(ATA_COMMAND_FLUSH_CACHE_EXT, NULL);
+}
+
+static void ahci_batch_begin(void)
+{
+    ahci_state.batch = true;
+}
+
+static void ahci_batch_end(void)
+{
+    ahci_state.batch = false;
+    ahci_wait(ahci_state.issued, true);
+}
+
+static void ahci_irq_activate(void)
+{
+    // Status lama hasil polling dibersihkan sebelum interrupt port & HBA dibuka
+    ahci_port_write(AHCI_PORT_IS, 0xFFFFFFFF);
+    ahci_hba_write(AHCI_HBA_IS, 0xFFFFFFFF);
+    ahci_port_write(AHCI_PORT_IE, AHCI_PORT_IE_DEFAULT);
+    ahci_hba_write(AHCI_HBA_GHC, ahci_hba_read(AHCI_HBA_GHC) | AHCI_GHC_IE);
+    ahci_state.irq_enabled = true;
+}
+
+static void ahci_isr(void)
+{
+    // Interrupt PCI level-triggered, status port lalu status HBA harus di-clear sebelum EOI (write 1 to clear)
+    uint32_t port_status = ahci_port_read(AHCI_PORT_IS);
+    ahci_port_write(AHCI_PORT_IS, port_status);
+    if (port_status & AHCI_PORT_IS_TFES)
+        ahci_state.error = true;
+    ahci_hba_write(AHCI_HBA_IS, 1u << ahci_state.port_number);
+    pic_ack(ahci_state.irq);
+}
+
+// Mencari port pertama yang terhubung dengan disk ATA, false jika tidak ada
+static bool ahci_find_port(void)
+{
+    uint32_t implemented = ahci_hba_read(AHCI_HBA_PI);
+    for (uint8_t port_number = 0; port_number < AHCI_HBA_PORT_COUNT; port_number++)
+    {
+        if (!(implemented & (1u << port_number)))
+            continue;
+
+        ahci_state.port = ahci_state.hba + AHCI_HBA_PORT_BASE + port_number * AHCI_HBA_PORT_SIZE;
+        if ((ahci_port_read(AHCI_PORT_SSTS) & AHCI_SSTS_DET_MASK) == AHCI_SSTS_DET_PRESENT &&
+            ahci_port_read(AHCI_PORT_SIG) == AHCI_SIG_ATA)
+        {
+            ahci_state.port_number = port_number;
+            return true;
+        }
+    }
+    ahci_state.port = NULL;
+    return false;
+}
+
+bool ahci_initialize(struct BlockDevice *device)
+{
+    struct PCIDevice controller;
+    if (!pci_find_device_by_class(PCI_CLASS_MASS_STORAGE, PCI_SUBCLASS_SATA, &controller) ||
+        controller.prog_if != PCI_PROG_IF_AHCI)
+        return false;
+
+    uint32_t abar = pci_read_bar(&controller, AHCI_ABAR_INDEX);
+    if (abar & PCI_BAR_IO_SPACE)
+        return false;
+
+    pci_enable_command(&controller, PCI_COMMAND_MEMORY_SPACE | PCI_COMMAND_BUS_MASTER);
+    ahci_state.hba = paging_map_kernel_mmio(&_paging_kernel_page_directory, abar & PCI_BAR_MEMORY_MASK, KERNEL_MMIO_VIRTUAL_ADDRESS);
+    ahci_hba_write(AHCI_HBA_GHC, ahci_hba_read(AHCI_HBA_GHC) | AHCI_GHC_AE);
+    if (!ahci_find_port())
+        return false;
+
+    uint32_t capability = ahci_hba_read(AHCI_HBA_CAP);
+    ahci_state.slot_count = ((capability >> AHCI_CAP_NCS_SHIFT) & AHCI_CAP_NCS_MASK) + 1;
+
+    // Port dihentikan sebelum command list & received FIS dipindahkan ke memory kernel
+    ahci_port_stop();
+    memset(ahci_command_list, 0, sizeof(ahci_command_list));
+    memset(ahci_received_fis, 0, sizeof(ahci_received_fis));
+    for (uint8_t slot = 0; slot < AHCI_SLOT_COUNT; slot++)
+        ahci_command_list[slot].command_table_address = ahci_physical(&ahci_command_table[slot]);
+    ahci_port_write(AHCI_PORT_CLB, ahci_physical(ahci_command_list));
+    ahci_port_write(AHCI_PORT_CLBU, 0);
+    ahci_port_write(AHCI_PORT_FB, ahci_physical(ahci_received_fis));
+    ahci_port_write(AHCI_PORT_FBU, 0);
+    ahci_port_restart();
+
+    if (!ahci_execute(ATA_COMMAND_IDENTIFY, ahci_bounce_buffer))
+        return false;
+    uint16_t *identify = (uint16_t *)ahci_bounce_buffer;
+    if (identify[ATA_IDENTIFY_COMMAND_SET_SUPPORT] & ATA_IDENTIFY_LBA48_SUPPORTED)
+        ahci_state.block_count = identify[ATA_IDENTIFY_LBA48_BLOCK_COUNT] | ((uint32_t)identify[ATA_IDENTIFY_LBA48_BLOCK_COUNT + 1] << 16);
+    else
+        ahci_state.block_count = identify[ATA_IDENTIFY_LBA28_BLOCK_COUNT] | ((uint32_t)identify[ATA_IDENTIFY_LBA28_BLOCK_COUNT + 1] << 16);
+
+    // NCQ butuh dukungan HBA & drive, jumlah slot dibatasi queue depth drive (word 75 bit 4:0 = depth - 1)
+    ahci_state.ncq = (capability & AHCI_CAP_SNCQ) && (identify[ATA_IDENTIFY_SATA_CAPABILITY] & ATA_IDENTIFY_NCQ_SUPPORTED);
+    if (ahci_state.ncq)
+    {
+        uint8_t queue_depth = (identify[ATA_IDENTIFY_QUEUE_DEPTH] & 0x1F) + 1;
+        if (ahci_state.slot_count > queue_depth)
+            ahci_state.slot_count = queue_depth;
+    }
+    ahci_state.irq = controller.interrupt_line < 16 ? controller.interrupt_line : BLOCK_DEVICE_IRQ_NONE;
+
+    device->read = ahci_read;
+    device->write = ahci_write;
+    device->flush = ahci_flush;
+    device->batch_begin = ahci_batch_begin;
+    device->batch_end = ahci_batch_end;
+    device->irq_activate = ahci_irq_activate;
+    device->isr = ahci_isr;
+    device->irq = ahci_state.irq;
+    device->block_count = ahci_state.block_count;
+    return true;
+}
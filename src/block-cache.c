@@ -0,0 +1,468 @@
+#include "header/cpu/block-cache.h"
+#include "header/cpu/block-queue.h"
+#include "header/stdlib/string.h"
+
+static struct BlockCacheState block_cache_state = {
+    .lru_head = BLOCK_CACHE_NONE,
+    .lru_tail = BLOCK_CACHE_NONE,
+    .line_count = 0,
+    .storage = NULL,
+    .write_back = false,
+};
+
+// Line index yang dirty, diurutkan berdasarkan LBA saat flush
+static uint16_t block_cache_flush_order[BLOCK_CACHE_MAX_LINE_COUNT];
+// Segment data line untuk run line bersebelahan yang ditransfer dengan satu command vectored
+static struct BlockSegment block_cache_segment[BLOCK_CACHE_FLUSH_LINE_COUNT];
+
+// Hash multiplicative (Knuth) untuk line number
+static uint32_t block_cache_hash(uint32_t line_number)
+{
+    return (line_number * 2654435761u) >> (32 - BLOCK_CACHE_HASH_BITS);
+}
+
+// Pointer ke data milik line index
+static uint8_t *block_cache_line_data(uint16_t index)
+{
+    return block_cache_state.storage + (uint32_t)index * BLOCK_CACHE_LINE_SIZE;
+}
+
+// Melepas line dari LRU list
+static void block_cache_lru_unlink(uint16_t index)
+{
+    struct BlockCacheLine *line = &block_cache_state.line[index];
+    if (line->lru_prev != BLOCK_CACHE_NONE)
+        block_cache_state.line[line->lru_prev].lru_next = line->lru_next;
+    else
+        block_cache_state.lru_head = line->lru_next;
+
+    if (line->lru_next != BLOCK_CACHE_NONE)
+        block_cache_state.line[line->lru_next].lru_prev = line->lru_prev;
+    else
+        block_cache_state.lru_tail = line->lru_prev;
+}
+
+// Menjadikan line sebagai most recently used
+static void block_cache_lru_touch(uint16_t index)
+{
+    if (block_cache_state.lru_head == index)
+        return;
+
+    block_cache_lru_unlink(index);
+    struct BlockCacheLine *line = &block_cache_state.line[index];
+    line->lru_prev = BLOCK_CACHE_NONE;
+    line->lru_next = block_cache_state.lru_head;
+    if (block_cache_state.lru_head != BLOCK_CACHE_NONE)
+        block_cache_state.line[block_cache_state.lru_head].lru_prev = index;
+    block_cache_state.lru_head = index;
+    if (block_cache_state.lru_tail == BLOCK_CACHE_NONE)
+        block_cache_state.lru_tail = index;
+}
+
+// Mencari line di hash table, BLOCK_CACHE_NONE jika tidak ada
+static uint16_t block_cache_lookup(uint32_t line_number)
+{
+    uint16_t index = block_cache_state.hash[block_cache_hash(line_number)];
+    while (index != BLOCK_CACHE_NONE)
+    {
+        if (block_cache_state.line[index].line_number == line_number)
+            return index;
+        index = block_cache_state.line[index].hash_next;
+    }
+    return BLOCK_CACHE_NONE;
+}
+
+// Menghapus line dari hash bucket
+static void block_cache_hash_remove(uint16_t index)
+{
+    uint32_t bucket = block_cache_hash(block_cache_state.line[index].line_number);
+    if (block_cache_state.hash[bucket] == index)
+    {
+        block_cache_state.hash[bucket] = block_cache_state.line[index].hash_next;
+        return;
+    }
+
+    uint16_t prev = block_cache_state.hash[bucket];
+    while (prev != BLOCK_CACHE_NONE && block_cache_state.line[prev].hash_next != index)
+        prev = block_cache_state.line[prev].hash_next;
+    if (prev != BLOCK_CACHE_NONE)
+        block_cache_state.line[prev].hash_next = block_cache_state.line[index].hash_next;
+}
+
+// Menandai block pada line sebagai dirty
+static void block_cache_mark_dirty(uint16_t index, uint8_t mask)
+{
+    struct BlockCacheLine *line = &block_cache_state.line[index];
+    if (line->dirty_mask == 0)
+    {
+        if (block_cache_state.dirty_count == 0)
+            block_cache_state.oldest_dirty_tick = block_cache_state.tick;
+        block_cache_state.dirty_count++;
+    }
+    line->dirty_mask |= mask;
+}
+
+// Menandai block pada line sebagai clean, dipanggil setelah block ditulis ke disk
+static void block_cache_clear_dirty(uint16_t index, uint8_t mask)
+{
+    struct BlockCacheLine *line = &block_cache_state.line[index];
+    if (line->dirty_mask == 0)
+        return;
+    line->dirty_mask &= ~mask;
+    if (line->dirty_mask == 0)
+        block_cache_state.dirty_count--;
+}
+
+// Menulis range block dirty pertama - terakhir dari satu line ke disk
+static void block_cache_write_line_back(uint16_t index)
+{
+    struct BlockCacheLine *line = &block_cache_state.line[index];
+    uint32_t first = 0;
+    while (!(line->dirty_mask & (1 << first)))
+        first++;
+    uint32_t last = BLOCK_CACHE_LINE_BLOCK_COUNT - 1;
+    while (!(line->dirty_mask & (1 << last)))
+        last--;
+
+    block_queue_write(
+        block_cache_line_data(index) + first * BLOCK_SIZE,
+        line->line_number * BLOCK_CACHE_LINE_BLOCK_COUNT + first,
+        last - first + 1);
+    block_cache_state.statistics.flush_write_command++;
+    block_cache_clear_dirty(index, line->dirty_mask);
+}
+
+// Mengambil line least recently used untuk line_number baru, data line belum diisi
+static uint16_t block_cache_allocate(uint32_t line_number)
+{
+    uint16_t index = block_cache_state.lru_tail;
+    struct BlockCacheLine *line = &block_cache_state.line[index];
+    if (line->valid)
+    {
+        // Victim dirty harus ditulis sebelum data line ditimpa
+        if (line->dirty_mask)
+            block_cache_write_line_back(index);
+        if (line->readahead)
+            block_cache_state.statistics.readahead_waste++;
+        block_cache_hash_remove(index);
+        block_cache_state.statistics.eviction++;
+    }
+
+    uint32_t bucket = block_cache_hash(line_number);
+    line->line_number = line_number;
+    line->valid = true;
+    line->readahead = false;
+    line->hash_next = block_cache_state.hash[bucket];
+    block_cache_state.hash[bucket] = index;
+    block_cache_lru_touch(index);
+    return index;
+}
+
+// Batas run line yang dibaca sekaligus, seperempat cache agar tidak mengusir seluruh working set
+static uint32_t block_cache_max_run(void)
+{
+    uint32_t max_run = block_cache_state.line_count / 4;
+    if (max_run > BLOCK_CACHE_FLUSH_LINE_COUNT)
+        max_run = BLOCK_CACHE_FLUSH_LINE_COUNT;
+    return max_run;
+}
+
+// Panjang run line mulai line_number (belum di-cache) sampai last_line yang juga belum di-cache
+static uint32_t block_cache_missing_run(uint32_t line_number, uint32_t last_line, uint32_t max_run)
+{
+    uint32_t run = 1;
+    while (run < max_run && line_number + run <= last_line && block_cache_lookup(line_number + run) == BLOCK_CACHE_NONE)
+        run++;
+    return run;
+}
+
+// Mengalokasikan run line lalu mengisinya langsung dari disk dengan satu command vectored
+static void block_cache_fill_run(uint32_t line_number, uint32_t run, bool readahead)
+{
+    for (uint32_t i = 0; i < run; i++)
+    {
+        uint16_t index = block_cache_allocate(line_number + i);
+        block_cache_state.line[index].readahead = readahead;
+        block_cache_segment[i].ptr = block_cache_line_data(index);
+        block_cache_segment[i].block_count = BLOCK_CACHE_LINE_BLOCK_COUNT;
+    }
+    block_queue_read_v(block_cache_segment, run, line_number * BLOCK_CACHE_LINE_BLOCK_COUNT);
+}
+
+void block_cache_initialize(void *storage, uint32_t storage_size)
+{
+    uint32_t line_count = storage_size / BLOCK_CACHE_LINE_SIZE;
+    if (line_count > BLOCK_CACHE_MAX_LINE_COUNT)
+        line_count = BLOCK_CACHE_MAX_LINE_COUNT;
+
+    block_cache_state.storage = (uint8_t *)storage;
+    block_cache_state.line_count = line_count;
+    for (uint32_t i = 0; i < BLOCK_CACHE_HASH_SIZE; i++)
+        block_cache_state.hash[i] = BLOCK_CACHE_NONE;
+
+    // Semua line kosong berada di LRU list, urutan index
+    for (uint32_t i = 0; i < line_count; i++)
+    {
+        struct BlockCacheLine *line = &block_cache_state.line[i];
+        line->valid = false;
+        line->dirty_mask = 0;
+        line->readahead = false;
+        line->hash_next = BLOCK_CACHE_NONE;
+        line->lru_prev = i == 0 ? BLOCK_CACHE_NONE : i - 1;
+        line->lru_next = i == line_count - 1 ? BLOCK_CACHE_NONE : i + 1;
+    }
+    block_cache_state.lru_head = line_count > 0 ? 0 : BLOCK_CACHE_NONE;
+    block_cache_state.lru_tail = line_count > 0 ? line_count - 1 : BLOCK_CACHE_NONE;
+    block_cache_state.dirty_count = 0;
+    memset(&block_cache_state.statistics, 0, sizeof(struct BlockCacheStatistics));
+}
+
+// Menimpa hasil bypass read dengan block dirty yang belum ditulis ke disk
+static void block_cache_overlay_dirty(void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    uint8_t *target = (uint8_t *)ptr;
+    uint32_t first_line = logical_block_address / BLOCK_CACHE_LINE_BLOCK_COUNT;
+    uint32_t last_line = (logical_block_address + block_count - 1) / BLOCK_CACHE_LINE_BLOCK_COUNT;
+    for (uint32_t line_number = first_line; line_number <= last_line; line_number++)
+    {
+        uint16_t index = block_cache_lookup(line_number);
+        if (index == BLOCK_CACHE_NONE || block_cache_state.line[index].dirty_mask == 0)
+            continue;
+
+        for (uint32_t i = 0; i < BLOCK_CACHE_LINE_BLOCK_COUNT; i++)
+        {
+            uint32_t lba = line_number * BLOCK_CACHE_LINE_BLOCK_COUNT + i;
+            if (!(block_cache_state.line[index].dirty_mask & (1 << i)) ||
+                lba < logical_block_address || lba >= logical_block_address + block_count)
+                continue;
+            memcpy(
+                target + (lba - logical_block_address) * BLOCK_SIZE,
+                block_cache_line_data(index) + i * BLOCK_SIZE,
+                BLOCK_SIZE);
+        }
+    }
+}
+
+void block_cache_read_blocks(void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    if (block_cache_state.line_count == 0 || block_count > BLOCK_CACHE_BYPASS_BLOCK_COUNT)
+    {
+        if (block_cache_state.line_count > 0)
+            block_cache_state.statistics.bypass++;
+        block_queue_read(ptr, logical_block_address, block_count);
+        if (block_cache_state.dirty_count > 0)
+            block_cache_overlay_dirty(ptr, logical_block_address, block_count);
+        return;
+    }
+
+    uint8_t *target = (uint8_t *)ptr;
+    uint32_t last_line = (logical_block_address + block_count - 1) / BLOCK_CACHE_LINE_BLOCK_COUNT;
+    // Line sebelum fresh_end baru diisi oleh run miss, tidak dihitung sebagai hit
+    uint32_t fresh_end = 0;
+    while (block_count > 0)
+    {
+        uint32_t line_number = logical_block_address / BLOCK_CACHE_LINE_BLOCK_COUNT;
+        uint32_t offset = logical_block_address % BLOCK_CACHE_LINE_BLOCK_COUNT;
+        uint32_t count = BLOCK_CACHE_LINE_BLOCK_COUNT - offset;
+        if (count > block_count)
+            count = block_count;
+
+        uint16_t index = block_cache_lookup(line_number);
+        if (index == BLOCK_CACHE_NONE)
+        {
+            // Run line miss berurutan di dalam range dibaca dengan satu command
+            uint32_t max_run = block_cache_max_run();
+            uint32_t run = block_cache_missing_run(line_number, last_line, max_run > 0 ? max_run : 1);
+            block_cache_fill_run(line_number, run, false);
+            block_cache_state.statistics.miss += run;
+            fresh_end = line_number + run;
+            index = block_cache_lookup(line_number);
+        }
+        else if (line_number >= fresh_end)
+        {
+            block_cache_state.statistics.hit++;
+            if (block_cache_state.line[index].readahead)
+            {
+                block_cache_state.line[index].readahead = false;
+                block_cache_state.statistics.readahead_hit++;
+            }
+            block_cache_lru_touch(index);
+        }
+        memcpy(target, block_cache_line_data(index) + offset * BLOCK_SIZE, count * BLOCK_SIZE);
+
+        target += count * BLOCK_SIZE;
+        logical_block_address += count;
+        block_count -= count;
+    }
+}
+
+void block_cache_prefetch(uint32_t logical_block_address, uint32_t block_count)
+{
+    if (block_cache_state.line_count == 0 || block_count == 0)
+        return;
+
+    uint32_t max_run = block_cache_max_run();
+    if (max_run == 0)
+        return;
+
+    uint32_t line_number = logical_block_address / BLOCK_CACHE_LINE_BLOCK_COUNT;
+    uint32_t last_line = (logical_block_address + block_count - 1) / BLOCK_CACHE_LINE_BLOCK_COUNT;
+    while (line_number <= last_line)
+    {
+        if (block_cache_lookup(line_number) != BLOCK_CACHE_NONE)
+        {
+            line_number++;
+            continue;
+        }
+
+        uint32_t run = block_cache_missing_run(line_number, last_line, max_run);
+        block_cache_fill_run(line_number, run, true);
+        block_cache_state.statistics.readahead += run;
+        line_number += run;
+    }
+}
+
+void block_cache_write_blocks(const void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    bool bypass = block_count > BLOCK_CACHE_BYPASS_BLOCK_COUNT;
+    bool write_back = block_cache_state.line_count > 0 && block_cache_state.write_back && !bypass;
+    if (block_cache_state.line_count > 0)
+    {
+        if (bypass)
+            block_cache_state.statistics.bypass++;
+
+        const uint8_t *source = (const uint8_t *)ptr;
+        uint32_t lba = logical_block_address;
+        uint32_t remaining = block_count;
+        while (remaining > 0)
+        {
+            uint32_t line_number = lba / BLOCK_CACHE_LINE_BLOCK_COUNT;
+            uint32_t offset = lba % BLOCK_CACHE_LINE_BLOCK_COUNT;
+            uint32_t count = BLOCK_CACHE_LINE_BLOCK_COUNT - offset;
+            if (count > remaining)
+                count = remaining;
+
+            // Line yang sudah ada selalu di-update, line baru dibuat jika ditulis penuh atau mode write-back
+            uint16_t index = block_cache_lookup(line_number);
+            if (index == BLOCK_CACHE_NONE && !bypass && (write_back || count == BLOCK_CACHE_LINE_BLOCK_COUNT))
+            {
+                index = block_cache_allocate(line_number);
+                // Line sebagian harus diisi dari disk agar block lain tetap valid
+                if (count < BLOCK_CACHE_LINE_BLOCK_COUNT)
+                {
+                    block_cache_state.statistics.miss++;
+                    block_queue_read(block_cache_line_data(index), line_number * BLOCK_CACHE_LINE_BLOCK_COUNT, BLOCK_CACHE_LINE_BLOCK_COUNT);
+                }
+            }
+            else if (index != BLOCK_CACHE_NONE)
+                block_cache_lru_touch(index);
+
+            if (index != BLOCK_CACHE_NONE)
+            {
+                uint8_t mask = ((1 << count) - 1) << offset;
+                block_cache_state.line[index].readahead = false;
+                memcpy(block_cache_line_data(index) + offset * BLOCK_SIZE, source, count * BLOCK_SIZE);
+                if (write_back)
+                    block_cache_mark_dirty(index, mask);
+                else
+                    block_cache_clear_dirty(index, mask);
+            }
+
+            source += count * BLOCK_SIZE;
+            lba += count;
+            remaining -= count;
+        }
+    }
+
+    if (!write_back)
+        block_queue_write(ptr, logical_block_address, block_count);
+    else if (block_cache_state.dirty_count >= BLOCK_CACHE_DIRTY_THRESHOLD)
+        block_cache_flush();
+}
+
+void block_cache_set_write_back(bool enabled)
+{
+    if (!enabled)
+        block_cache_flush();
+    block_cache_state.write_back = enabled;
+}
+
+void block_cache_flush(void)
+{
+    if (block_cache_state.dirty_count == 0)
+        return;
+    block_cache_state.statistics.flush++;
+    // Semua run dikirim sebagai satu batch elevator
+    block_queue_plug();
+
+    // Insertion sort line dirty berdasarkan line number, jumlah line dirty umumnya kecil
+    uint32_t dirty_count = 0;
+    for (uint16_t i = 0; i < block_cache_state.line_count; i++)
+    {
+        if (!block_cache_state.line[i].dirty_mask)
+            continue;
+        uint32_t j = dirty_count++;
+        while (j > 0 && block_cache_state.line[block_cache_flush_order[j - 1]].line_number > block_cache_state.line[i].line_number)
+        {
+            block_cache_flush_order[j] = block_cache_flush_order[j - 1];
+            j--;
+        }
+        block_cache_flush_order[j] = i;
+    }
+
+    uint32_t i = 0;
+    while (i < dirty_count)
+    {
+        // Mencari run line dengan line number berurutan
+        uint32_t run = 1;
+        while (i + run < dirty_count && run < BLOCK_CACHE_FLUSH_LINE_COUNT &&
+               block_cache_state.line[block_cache_flush_order[i + run]].line_number ==
+                   block_cache_state.line[block_cache_flush_order[i]].line_number + run)
+            run++;
+
+        if (run == 1)
+            block_cache_write_line_back(block_cache_flush_order[i]);
+        else
+        {
+            // Line selalu valid penuh, sehingga run ditulis utuh dalam satu command
+            for (uint32_t j = 0; j < run; j++)
+            {
+                uint16_t index = block_cache_flush_order[i + j];
+                block_cache_segment[j].ptr = block_cache_line_data(index);
+                block_cache_segment[j].block_count = BLOCK_CACHE_LINE_BLOCK_COUNT;
+                block_cache_clear_dirty(index, block_cache_state.line[index].dirty_mask);
+            }
+            block_queue_write_v(
+                block_cache_segment,
+                run,
+                block_cache_state.line[block_cache_flush_order[i]].line_number * BLOCK_CACHE_LINE_BLOCK_COUNT);
+            block_cache_state.statistics.flush_write_command++;
+        }
+        i += run;
+    }
+    block_queue_unplug();
+}
+
+void block_cache_sync(void)
+{
+    block_cache_flush();
+    block_queue_dispatch();
+    flush_blocks();
+}
+
+void block_cache_timer_tick(void)
+{
+    block_cache_state.tick++;
+}
+
+void block_cache_flush_if_due(void)
+{
+    if (block_cache_state.dirty_count > 0 &&
+        block_cache_state.tick - block_cache_state.oldest_dirty_tick >= BLOCK_CACHE_FLUSH_INTERVAL_TICKS)
+        block_cache_flush();
+}
+
+void block_cache_get_statistics(struct BlockCacheStatistics *statistics)
+{
+    *statistics = block_cache_state.statistics;
+}
@@ -0,0 +1,253 @@
+#include "header/cpu/block-queue.h"
+#include "header/stdlib/string.h"
+
+static struct BlockQueueState block_queue_state = {
+    .pending_count = 0,
+    .plug_depth = 0,
+    .data_used = 0,
+};
+
+// Salinan data write yang menunggu dispatch
+static uint8_t block_queue_data[BLOCK_QUEUE_DATA_BLOCK_COUNT * BLOCK_SIZE];
+// Segment command gabungan, satu segment untuk setiap request
+static struct BlockSegment block_queue_segment[BLOCK_QUEUE_REQUEST_COUNT];
+
+// Pointer ke data write milik request di pool
+static uint8_t *block_queue_request_data(const struct BlockRequest *request)
+{
+    return block_queue_data + (uint32_t)request->data_block * BLOCK_SIZE;
+}
+
+// Menyalin daftar segment secara berurutan ke buffer kontigu
+static void block_queue_gather(uint8_t *target, const struct BlockSegment *segment, uint32_t segment_count)
+{
+    for (uint32_t i = 0; i < segment_count; i++)
+    {
+        memcpy(target, segment[i].ptr, segment[i].block_count * BLOCK_SIZE);
+        target += segment[i].block_count * BLOCK_SIZE;
+    }
+}
+
+// True jika request dan range [logical_block_address, logical_block_address + block_count) beririsan
+static bool block_queue_overlap(const struct BlockRequest *request, uint32_t logical_block_address, uint32_t block_count)
+{
+    return request->logical_block_address < logical_block_address + block_count &&
+           logical_block_address < request->logical_block_address + request->block_count;
+}
+
+// Menandai request selesai, slot internal dikembalikan
+static void block_queue_complete(struct BlockRequest *request)
+{
+    request->done = true;
+    request->used = false;
+    if (request->callback != NULL)
+        request->callback(request);
+}
+
+// Mentransfer request pending[first, first + run) yang bersebelahan dengan satu command vectored
+static void block_queue_transfer(uint8_t first, uint8_t run)
+{
+    for (uint8_t i = 0; i < run; i++)
+    {
+        struct BlockRequest *request = block_queue_state.pending[first + i];
+        block_queue_segment[i].ptr = request->write ? block_queue_request_data(request) : request->ptr;
+        block_queue_segment[i].block_count = request->block_count;
+    }
+
+    struct BlockRequest *head = block_queue_state.pending[first];
+    if (head->write)
+        write_blocks_v(block_queue_segment, run, head->logical_block_address);
+    else
+        read_blocks_v(block_queue_segment, run, head->logical_block_address);
+}
+
+void block_queue_dispatch(void)
+{
+    uint8_t pending_count = block_queue_state.pending_count;
+    if (pending_count == 0)
+        return;
+
+    // Satu sapuan elevator naik, pending sudah terurut berdasarkan LBA.
+    // Request dalam satu dispatch tidak saling beririsan, sehingga command boleh diantrikan di device (NCQ)
+    disk_batch_begin();
+    uint8_t i = 0;
+    while (i < pending_count)
+    {
+        struct BlockRequest *head = block_queue_state.pending[i];
+        uint32_t block_count = head->block_count;
+        uint8_t run = 1;
+        while (i + run < pending_count)
+        {
+            struct BlockRequest *next = block_queue_state.pending[i + run];
+            if (next->write != head->write ||
+                next->logical_block_address != head->logical_block_address + block_count ||
+                block_count + next->block_count > BLOCK_QUEUE_MERGE_BLOCK_COUNT)
+                break;
+            block_count += next->block_count;
+            run++;
+        }
+
+        block_queue_transfer(i, run);
+        block_queue_state.statistics.command++;
+        block_queue_state.statistics.merged += run - 1;
+        i += run;
+    }
+    disk_batch_end();
+
+    // Queue dikosongkan sebelum callback, sehingga callback boleh submit request baru
+    struct BlockRequest *completed[BLOCK_QUEUE_REQUEST_COUNT];
+    memcpy(completed, block_queue_state.pending, pending_count * sizeof(struct BlockRequest *));
+    block_queue_state.pending_count = 0;
+    block_queue_state.data_used = 0;
+    for (i = 0; i < pending_count; i++)
+        block_queue_complete(completed[i]);
+}
+
+// Submit request dengan sumber write berupa daftar segment
+static void block_queue_enqueue(struct BlockRequest *request, const struct BlockSegment *segment, uint32_t segment_count)
+{
+    block_queue_state.statistics.submitted++;
+    request->done = false;
+
+    // Urutan terhadap request yang beririsan dijaga dengan dispatch lebih dulu,
+    // kecuali write dengan range sama yang cukup menimpa data pending
+    for (uint8_t i = 0; i < block_queue_state.pending_count; i++)
+    {
+        struct BlockRequest *pending = block_queue_state.pending[i];
+        if (!block_queue_overlap(pending, request->logical_block_address, request->block_count) ||
+            (!pending->write && !request->write))
+            continue;
+        if (pending->write && request->write &&
+            pending->logical_block_address == request->logical_block_address &&
+            pending->block_count == request->block_count)
+        {
+            block_queue_gather(block_queue_request_data(pending), segment, segment_count);
+            block_queue_state.statistics.coalesced++;
+            block_queue_complete(request);
+            return;
+        }
+        block_queue_dispatch();
+        break;
+    }
+
+    // Write yang lebih besar dari pool tidak diantrikan
+    if (request->write && request->block_count > BLOCK_QUEUE_DATA_BLOCK_COUNT)
+    {
+        write_blocks_v(segment, segment_count, request->logical_block_address);
+        block_queue_state.statistics.command++;
+        block_queue_complete(request);
+        return;
+    }
+
+    if (block_queue_state.pending_count == BLOCK_QUEUE_REQUEST_COUNT ||
+        (request->write && block_queue_state.data_used + request->block_count > BLOCK_QUEUE_DATA_BLOCK_COUNT))
+        block_queue_dispatch();
+
+    if (request->write)
+    {
+        request->data_block = block_queue_state.data_used;
+        block_queue_gather(block_queue_request_data(request), segment, segment_count);
+        block_queue_state.data_used += request->block_count;
+    }
+
+    // Insertion berdasarkan LBA, request dengan LBA sama tetap berurutan sesuai submit
+    uint8_t i = block_queue_state.pending_count++;
+    while (i > 0 && block_queue_state.pending[i - 1]->logical_block_address > request->logical_block_address)
+    {
+        block_queue_state.pending[i] = block_queue_state.pending[i - 1];
+        i--;
+    }
+    block_queue_state.pending[i] = request;
+
+    if (block_queue_state.plug_depth == 0)
+        block_queue_dispatch();
+}
+
+void block_queue_submit(struct BlockRequest *request)
+{
+    struct BlockSegment segment = {.ptr = request->ptr, .block_count = request->block_count};
+    block_queue_enqueue(request, &segment, 1);
+}
+
+void block_queue_wait(struct BlockRequest *request)
+{
+    if (!request->done)
+        block_queue_dispatch();
+}
+
+void block_queue_plug(void)
+{
+    block_queue_state.plug_depth++;
+}
+
+void block_queue_unplug(void)
+{
+    if (block_queue_state.plug_depth > 0 && --block_queue_state.plug_depth == 0)
+        block_queue_dispatch();
+}
+
+// Slot request internal yang kosong, dispatch jika semua slot menunggu
+static struct BlockRequest *block_queue_internal_request(void)
+{
+    for (uint8_t i = 0; i < BLOCK_QUEUE_REQUEST_COUNT; i++)
+        if (!block_queue_state.internal[i].used)
+            return &block_queue_state.internal[i];
+
+    // Semua slot menunggu dispatch, setelah dispatch semua slot kosong
+    block_queue_dispatch();
+    return &block_queue_state.internal[0];
+}
+
+void block_queue_write_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    uint32_t block_count = 0;
+    for (uint32_t i = 0; i < segment_count; i++)
+        block_count += segment[i].block_count;
+    if (block_count == 0)
+        return;
+
+    struct BlockRequest *request = block_queue_internal_request();
+    request->used = true;
+    request->ptr = segment[0].ptr;
+    request->logical_block_address = logical_block_address;
+    request->block_count = block_count;
+    request->write = true;
+    request->callback = NULL;
+    request->context = NULL;
+    block_queue_enqueue(request, segment, segment_count);
+}
+
+void block_queue_write(const void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    struct BlockSegment segment = {.ptr = (void *)ptr, .block_count = block_count};
+    block_queue_write_v(&segment, 1, logical_block_address);
+}
+
+void block_queue_read_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    uint32_t block_count = 0;
+    for (uint32_t i = 0; i < segment_count; i++)
+        block_count += segment[i].block_count;
+
+    for (uint8_t i = 0; i < block_queue_state.pending_count; i++)
+    {
+        if (block_queue_state.pending[i]->write &&
+            block_queue_overlap(block_queue_state.pending[i], logical_block_address, block_count))
+        {
+            block_queue_dispatch();
+            break;
+        }
+    }
+    read_blocks_v(segment, segment_count, logical_block_address);
+}
+
+void block_queue_read(void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    struct BlockSegment segment = {.ptr = ptr, .block_count = block_count};
+    block_queue_read_v(&segment, 1, logical_block_address);
+}
+
+void block_queue_get_statistics(struct BlockQueueStatistics *statistics)
+{
+    *statistics = block_queue_state.statistics;
+}
@@ -1,58 +1,538 @@
 #include "header/cpu/disk.h"
 #include "header/cpu/portio.h"
+#include "header/cpu/interrupt.h"
+#include "header/cpu/paging.h"
+#include "header/cpu/pci.h"
+#include "header/cpu/ahci.h"
+#include "header/cpu/virtio-blk.h"
+#include "header/stdlib/string.h"
+
+// Flag yang di-set oleh ata_isr() ketika drive mengirimkan IRQ14
+static volatile bool ata_irq_received = false;
+// Apakah jalur completion berbasis interrupt sudah aktif
+static bool ata_irq_enabled = false;
+
+// Kapabilitas drive hasil IDENTIFY, default: LBA28 tanpa READ / WRITE MULTIPLE
+static struct ATADriveInformation ata_drive = {
+    .present = false,
+    .lba48 = false,
+    .block_count = 0,
+    .multiple_block_count = 1,
+};
+
+// Base port bus master channel primary (BAR4), 0 jika DMA tidak tersedia
+static uint16_t ata_bm_base = 0;
+// PRD table dan bounce buffer berada di image kernel, physical = virtual - KERNEL_VIRTUAL_BASE
+// PRD table di-align sebesar ukurannya dan bounce buffer di-align 64 KiB agar tidak melewati batas 64 KiB
+static struct ATAPhysicalRegionDescriptor ata_prd_table[ATA_PRD_TABLE_SIZE] __attribute__((aligned(ATA_PRD_TABLE_SIZE * sizeof(struct ATAPhysicalRegionDescriptor))));
+static uint8_t ata_dma_buffer[ATA_DMA_BUFFER_SIZE] __attribute__((aligned(ATA_DMA_BUFFER_SIZE)));
 
 // Menunggu hingga disk tidak sibuk
 static void ATA_busy_wait()
 {
-    while (in(0x1F7) & ATA_STATUS_BSY)
+    while (in(ATA_PRIMARY_COMMAND_STATUS) & ATA_STATUS_BSY)
         ;
 }
 
-// Menunggu sampai disk siap untuk transfer data
+// Menunggu sampai disk siap untuk transfer data (atau melaporkan error)
 static void ATA_DRQ_wait()
 {
-    while (!(in(0x1F7) & ATA_STATUS_RDY))
+    while (!(in(ATA_PRIMARY_COMMAND_STATUS) & (ATA_STATUS_DRQ | ATA_STATUS_ERR | ATA_STATUS_DF)))
         ;
 }
 
-// Membaca blok dari disk
-void read_blocks(void *ptr, uint32_t logical_block_address, uint8_t block_count)
+// Menunggu IRQ14 dari disk, CPU di-HLT selama drive masih sibuk
+static void ATA_irq_wait()
+{
+    if (!ata_irq_enabled)
+        return;
+
+    uint32_t eflags;
+    __asm__ volatile("pushf; pop %0; cli" : "=r"(eflags) : /* <Empty> */ : "memory");
+    // Alternate status tidak meng-ACK interrupt, aman untuk dicek sebelum HLT
+    while (!ata_irq_received && (in(ATA_PRIMARY_CONTROL) & ATA_STATUS_BSY))
+        // sti baru berlaku setelah instruksi berikutnya, sehingga tidak ada IRQ yang terlewat sebelum hlt
+        __asm__ volatile("sti; hlt; cli" ::: "memory");
+    ata_irq_received = false;
+    if (eflags & EFLAGS_INTERRUPT_FLAG)
+        __asm__ volatile("sti");
+}
+
+// Mengirimkan LBA, jumlah blok, dan command ke drive. LBA48 mengirim byte tinggi terlebih dahulu
+static void ATA_issue_command(uint32_t logical_block_address, uint32_t block_count, uint8_t command, bool lba48)
+{
+    ATA_busy_wait();
+    ata_irq_received = false;
+    if (lba48)
+    {
+        out(ATA_PRIMARY_DRIVE_HEAD, ATA_DRIVE_MASTER_LBA48);
+        out(ATA_PRIMARY_SECTOR_COUNT, (uint8_t)(block_count >> 8));       // Sector count 15:8
+        out(ATA_PRIMARY_LBA_LOW, (uint8_t)(logical_block_address >> 24)); // LBA 31:24
+        out(ATA_PRIMARY_LBA_MID, 0);                                      // LBA 39:32
+        out(ATA_PRIMARY_LBA_HIGH, 0);                                     // LBA 47:40
+    }
+    else
+    {
+        out(ATA_PRIMARY_DRIVE_HEAD, ATA_DRIVE_MASTER_LBA | ((logical_block_address >> 24) & 0xF)); // Mengirimkan 4 bit tinggi dari LBA ke port drive/head
+    }
+    out(ATA_PRIMARY_SECTOR_COUNT, (uint8_t)block_count);               // Mengirimkan jumlah blok ke port count
+    out(ATA_PRIMARY_LBA_LOW, (uint8_t)logical_block_address);          // Mengirimkan 8 bit terendah dari LBA ke port LBAlo
+    out(ATA_PRIMARY_LBA_MID, (uint8_t)(logical_block_address >> 8));   // Mengirimkan 8 bit berikutnya dari LBA ke port LBAmid
+    out(ATA_PRIMARY_LBA_HIGH, (uint8_t)(logical_block_address >> 16)); // Mengirimkan 8 bit berikutnya dari LBA ke port LBAhi
+    out(ATA_PRIMARY_COMMAND_STATUS, command);                          // Mengirimkan command ke port command/status
+
+    // Delay 400ns agar bit BSY sudah valid sebelum dicek
+    for (uint8_t i = 0; i < 4; i++)
+        in(ATA_PRIMARY_CONTROL);
+}
+
+// Jumlah blok maksimal untuk satu command sesuai mode addressing
+static uint32_t ATA_max_block_count(void)
+{
+    return ata_drive.lba48 ? ATA_LBA48_MAX_BLOCK_COUNT : ATA_LBA28_MAX_BLOCK_COUNT;
+}
+
+// Mengaktifkan interrupt drive ATA (IRQ14)
+static void ATA_irq_activate(void)
+{
+    // nIEN = 0, drive boleh mengirimkan interrupt
+    out(ATA_PRIMARY_CONTROL, 0);
+    ata_irq_received = false;
+    ata_irq_enabled = true;
+}
+
+// ISR IRQ14
+static void ATA_isr(void)
+{
+    // Membaca status register untuk ACK interrupt dari drive
+    in(ATA_PRIMARY_COMMAND_STATUS);
+    ata_irq_received = true;
+    pic_ack(PIC1_OFFSET + IRQ_PRIMARY_ATA);
+}
+
+// IDENTIFY DEVICE dan mengaktifkan READ / WRITE MULTIPLE jika didukung drive
+static void ATA_identify(void)
 {
+    ATA_issue_command(0, 0, ATA_COMMAND_IDENTIFY, false);
+    // Status 0 berarti tidak ada drive di bus
+    if (in(ATA_PRIMARY_COMMAND_STATUS) == 0)
+        return;
+
+    ATA_irq_wait();
     ATA_busy_wait();
-    out(0x1F6, 0xE0 | ((logical_block_address >> 24) & 0xF)); // Mengirimkan 4 bit tinggi dari LBA ke port drive/head
-    out(0x1F2, block_count); // Mengirimkan jumlah blok yang akan dibaca ke port count
-    out(0x1F3, (uint8_t)logical_block_address); // Mengirimkan 8 bit terendah dari LBA ke port LBAlo
-    out(0x1F4, (uint8_t)(logical_block_address >> 8)); // Mengirimkan 8 bit berikutnya dari LBA ke port LBAmid
-    out(0x1F5, (uint8_t)(logical_block_address >> 16)); // Mengirimkan 8 bit berikutnya dari LBA ke port LBAhi
-    out(0x1F7, 0x20);  // Mengirimkan perintah baca ke port command/status
-
-    uint16_t *target = (uint16_t *)ptr;
+    ATA_DRQ_wait();
+    if (in(ATA_PRIMARY_COMMAND_STATUS) & (ATA_STATUS_ERR | ATA_STATUS_DF))
+        return;
+
+    uint16_t identify[HALF_BLOCK_SIZE];
+    for (uint32_t i = 0; i < HALF_BLOCK_SIZE; i++)
+        identify[i] = in16(ATA_PRIMARY_DATA);
+
+    ata_drive.present = true;
+    ata_drive.lba48 = identify[ATA_IDENTIFY_COMMAND_SET_SUPPORT] & ATA_IDENTIFY_LBA48_SUPPORTED;
+    if (ata_drive.lba48)
+        ata_drive.block_count = identify[ATA_IDENTIFY_LBA48_BLOCK_COUNT] | ((uint32_t)identify[ATA_IDENTIFY_LBA48_BLOCK_COUNT + 1] << 16);
+    else
+        ata_drive.block_count = identify[ATA_IDENTIFY_LBA28_BLOCK_COUNT] | ((uint32_t)identify[ATA_IDENTIFY_LBA28_BLOCK_COUNT + 1] << 16);
+
+    // Word 47 bit 7:0, jumlah sektor maksimal per DRQ block
+    uint8_t max_multiple = identify[ATA_IDENTIFY_MAX_MULTIPLE] & 0xFF;
+    if (max_multiple > 1)
+    {
+        ATA_issue_command(0, max_multiple, ATA_COMMAND_SET_MULTIPLE_MODE, false);
+        ATA_irq_wait();
+        ATA_busy_wait();
+        if (!(in(ATA_PRIMARY_COMMAND_STATUS) & (ATA_STATUS_ERR | ATA_STATUS_DF)))
+            ata_drive.multiple_block_count = max_multiple;
+    }
+}
+
+// Mencari IDE controller di PCI dan mengaktifkan bus master DMA
+static void ATA_DMA_initialize(void)
+{
+    struct PCIDevice controller;
+    if (!pci_find_device_by_class(PCI_CLASS_MASS_STORAGE, PCI_SUBCLASS_IDE, &controller))
+        return;
+    if (!(controller.prog_if & ATA_PROG_IF_BUS_MASTER))
+        return;
+
+    uint32_t bar4 = pci_read_bar(&controller, 4);
+    if (!(bar4 & PCI_BAR_IO_SPACE))
+        return;
+
+    pci_enable_command(&controller, PCI_COMMAND_IO_SPACE | PCI_COMMAND_BUS_MASTER);
+    ata_bm_base = bar4 & PCI_BAR_IO_MASK;
+}
+
+
+void block_segment_advance(const struct BlockSegment *segment, uint32_t *index, uint32_t *offset, uint32_t block_count)
+{
+    *offset += block_count;
+    while (*offset > 0 && *offset >= segment[*index].block_count)
+    {
+        *offset -= segment[*index].block_count;
+        (*index)++;
+    }
+}
+
+uint8_t *block_segment_pointer(const struct BlockSegment *segment, uint32_t *index, uint32_t *offset)
+{
+    while (*offset >= segment[*index].block_count)
+    {
+        *offset -= segment[*index].block_count;
+        (*index)++;
+    }
+    return (uint8_t *)segment[*index].ptr + *offset * BLOCK_SIZE;
+}
+
+void block_segment_copy(const struct BlockSegment *segment, uint32_t index, uint32_t offset,
+                        uint8_t *buffer, uint32_t block_count, bool to_buffer)
+{
     for (uint32_t i = 0; i < block_count; i++)
     {
+        uint8_t *block = block_segment_pointer(segment, &index, &offset);
+        if (to_buffer)
+            memcpy(buffer + i * BLOCK_SIZE, block, BLOCK_SIZE);
+        else
+            memcpy(block, buffer + i * BLOCK_SIZE, BLOCK_SIZE);
+        offset++;
+    }
+}
+
+/**
+ * Menambahkan entry PRD mulai *prd_count yang langsung menunjuk memory caller, dipecah pada batas page 4 MiB dan batas 64 KiB.
+ * Mengembalikan jumlah blok yang tercakup (bisa lebih kecil dari block_count jika PRD table penuh),
+ * 0 jika memory tidak bisa di-DMA langsung (tidak ter-mapping atau tidak 2-byte aligned)
+ */
+static uint32_t ATA_DMA_append_prd(const void *ptr, uint32_t block_count, uint32_t *prd_count)
+{
+    uint32_t virtual_addr = (uint32_t)ptr;
+    uint32_t remaining = block_count * BLOCK_SIZE;
+    uint32_t covered = 0;
+    uint32_t first_entry = *prd_count;
+    if (virtual_addr & 1)
+        return 0;
+
+    while (remaining > 0 && *prd_count < ATA_PRD_TABLE_SIZE)
+    {
+        uint32_t physical_addr;
+        if (!paging_virtual_to_physical(&_paging_kernel_page_directory, (void *)virtual_addr, &physical_addr))
+            break;
+
+        uint32_t length = remaining;
+        uint32_t to_64k = ATA_PRD_MAX_BYTE_COUNT - (physical_addr & (ATA_PRD_MAX_BYTE_COUNT - 1));
+        uint32_t to_page = PAGE_FRAME_SIZE - (virtual_addr & (PAGE_FRAME_SIZE - 1));
+        if (length > to_64k)
+            length = to_64k;
+        if (length > to_page)
+            length = to_page;
+
+        ata_prd_table[*prd_count].physical_address = physical_addr;
+        ata_prd_table[*prd_count].byte_count = (uint16_t)length; // 0x10000 overflow menjadi 0 = 64 KiB
+        ata_prd_table[*prd_count].flag = 0;
+        (*prd_count)++;
+        virtual_addr += length;
+        remaining -= length;
+        covered += length;
+    }
+
+    // Total PRD harus kelipatan BLOCK_SIZE, potong entry terakhir region ini jika perlu
+    uint32_t excess = covered % BLOCK_SIZE;
+    covered -= excess;
+    while (excess > 0 && *prd_count > first_entry)
+    {
+        struct ATAPhysicalRegionDescriptor *last = &ata_prd_table[*prd_count - 1];
+        uint32_t length = last->byte_count ? last->byte_count : ATA_PRD_MAX_BYTE_COUNT;
+        if (length > excess)
+        {
+            last->byte_count = (uint16_t)(length - excess);
+            excess = 0;
+        }
+        else
+        {
+            excess -= length;
+            (*prd_count)--;
+        }
+    }
+    return covered / BLOCK_SIZE;
+}
+
+// PRD table menunjuk bounce buffer, block_count maksimal ATA_DMA_MAX_BLOCK_COUNT
+static void ATA_DMA_build_bounce_prd(uint32_t block_count)
+{
+    ata_prd_table[0].physical_address = (uint32_t)ata_dma_buffer - KERNEL_VIRTUAL_BASE;
+    ata_prd_table[0].byte_count = (uint16_t)(block_count * BLOCK_SIZE);
+    ata_prd_table[0].flag = ATA_PRD_END_OF_TABLE;
+}
+
+// Transfer DMA satu command sesuai PRD table, false jika controller / drive melaporkan error
+static bool ATA_DMA_transfer(uint32_t logical_block_address, uint32_t block_count, bool is_read)
+{
+    // Stop engine, set arah transfer, PRD table, dan clear bit error & interrupt (write 1 to clear)
+    out(ata_bm_base + ATA_BM_COMMAND, 0);
+    out32(ata_bm_base + ATA_BM_PRDT_ADDRESS, (uint32_t)ata_prd_table - KERNEL_VIRTUAL_BASE);
+    out(ata_bm_base + ATA_BM_COMMAND, is_read ? ATA_BM_COMMAND_READ : 0);
+    out(ata_bm_base + ATA_BM_STATUS, ATA_BM_STATUS_ERROR | ATA_BM_STATUS_IRQ);
+
+    uint8_t command;
+    if (ata_drive.lba48)
+        command = is_read ? ATA_COMMAND_READ_DMA_EXT : ATA_COMMAND_WRITE_DMA_EXT;
+    else
+        command = is_read ? ATA_COMMAND_READ_DMA : ATA_COMMAND_WRITE_DMA;
+    ATA_issue_command(logical_block_address, block_count, command, ata_drive.lba48);
+    out(ata_bm_base + ATA_BM_COMMAND, (is_read ? ATA_BM_COMMAND_READ : 0) | ATA_BM_COMMAND_START);
+
+    // Satu IRQ untuk seluruh transfer
+    ATA_irq_wait();
+    uint8_t bm_status;
+    do
+        bm_status = in(ata_bm_base + ATA_BM_STATUS);
+    while ((bm_status & ATA_BM_STATUS_ACTIVE) && !(bm_status & (ATA_BM_STATUS_IRQ | ATA_BM_STATUS_ERROR)));
+
+    out(ata_bm_base + ATA_BM_COMMAND, 0);
+    ATA_busy_wait();
+    uint8_t status = in(ATA_PRIMARY_COMMAND_STATUS);
+    out(ata_bm_base + ATA_BM_STATUS, ATA_BM_STATUS_ERROR | ATA_BM_STATUS_IRQ);
+
+    return !(bm_status & ATA_BM_STATUS_ERROR) && !(status & (ATA_STATUS_ERR | ATA_STATUS_DF));
+}
+
+/**
+ * Satu command DMA mulai posisi (index, offset) pada daftar segment. Setiap segment menjadi entry PRD sendiri
+ * (scatter-gather), segment yang tidak bisa di-DMA langsung ditransfer melalui bounce buffer.
+ * Mengembalikan jumlah blok yang ditransfer, 0 jika DMA gagal
+ */
+static uint32_t ATA_DMA_rw(const struct BlockSegment *segment, uint32_t index, uint32_t offset,
+                           uint32_t logical_block_address, uint32_t block_count, bool is_read)
+{
+    uint32_t prd_count = 0;
+    uint32_t count = 0;
+    while (count < block_count)
+    {
+        uint8_t *ptr = block_segment_pointer(segment, &index, &offset);
+        uint32_t want = segment[index].block_count - offset;
+        if (want > block_count - count)
+            want = block_count - count;
+        uint32_t covered = ATA_DMA_append_prd(ptr, want, &prd_count);
+        count += covered;
+        if (covered < want)
+            break; // PRD table penuh atau memory tidak bisa di-DMA, sisanya command berikutnya
+        offset += covered;
+    }
+    if (count > 0)
+    {
+        ata_prd_table[prd_count - 1].flag = ATA_PRD_END_OF_TABLE;
+        return ATA_DMA_transfer(logical_block_address, count, is_read) ? count : 0;
+    }
+
+    count = block_count < ATA_DMA_MAX_BLOCK_COUNT ? block_count : ATA_DMA_MAX_BLOCK_COUNT;
+    ATA_DMA_build_bounce_prd(count);
+    if (!is_read)
+        block_segment_copy(segment, index, offset, ata_dma_buffer, count, true);
+    if (!ATA_DMA_transfer(logical_block_address, count, is_read))
+        return 0;
+    if (is_read)
+        block_segment_copy(segment, index, offset, ata_dma_buffer, count, false);
+    return count;
+}
+
+// Membaca blok dari disk dengan ATA PIO ke daftar segment, satu IRQ untuk setiap DRQ block (READ MULTIPLE)
+static void ATA_PIO_read(const struct BlockSegment *segment, uint32_t index, uint32_t offset,
+                         uint32_t logical_block_address, uint32_t block_count)
+{
+    uint8_t command;
+    if (ata_drive.multiple_block_count > 1)
+        command = ata_drive.lba48 ? ATA_COMMAND_READ_MULTIPLE_EXT : ATA_COMMAND_READ_MULTIPLE;
+    else
+        command = ata_drive.lba48 ? ATA_COMMAND_READ_SECTORS_EXT : ATA_COMMAND_READ_SECTORS;
+    ATA_issue_command(logical_block_address, block_count, command, ata_drive.lba48);
+
+    for (uint32_t i = 0; i < block_count; i += ata_drive.multiple_block_count)
+    {
+        uint32_t drq_block_count = block_count - i;
+        if (drq_block_count > ata_drive.multiple_block_count)
+            drq_block_count = ata_drive.multiple_block_count;
+
+        // Drive mengirimkan IRQ setiap satu DRQ block siap dibaca
+        ATA_irq_wait();
         ATA_busy_wait();
         ATA_DRQ_wait();
-        for (uint32_t j = 0; j < HALF_BLOCK_SIZE; j++)
-            target[j] = in16(0x1F0);
-        target += HALF_BLOCK_SIZE;
+        for (uint32_t j = 0; j < drq_block_count; j++)
+        {
+            uint16_t *target = (uint16_t *)block_segment_pointer(segment, &index, &offset);
+            for (uint32_t k = 0; k < HALF_BLOCK_SIZE; k++)
+                target[k] = in16(ATA_PRIMARY_DATA);
+            offset++;
+        }
     }
 }
 
-// Menulis blok data ke disk
-void write_blocks(const void *ptr, uint32_t logical_block_address, uint8_t block_count)
+// Menulis blok data dari daftar segment ke disk dengan ATA PIO, satu IRQ untuk setiap DRQ block (WRITE MULTIPLE)
+static void ATA_PIO_write(const struct BlockSegment *segment, uint32_t index, uint32_t offset,
+                          uint32_t logical_block_address, uint32_t block_count)
 {
-    ATA_busy_wait();
-    out(0x1F6, 0xE0 | ((logical_block_address >> 24) & 0xF));  // Mengirimkan 4 bit tinggi dari LBA ke port drive/head
-    out(0x1F2, block_count); // Mengirimkan jumlah blok yang akan ditulis ke port count
-    out(0x1F3, (uint8_t)logical_block_address); // Mengirimkan 8 bit terendah dari LBA ke port LBAlo
-    out(0x1F4, (uint8_t)(logical_block_address >> 8));  // Mengirimkan 8 bit berikutnya dari LBA ke port LBAmid
-    out(0x1F5, (uint8_t)(logical_block_address >> 16)); // Mengirimkan 8 bit berikutnya dari LBA ke port LBAhi
-    out(0x1F7, 0x30);  // Mengirimkan perintah tulis ke port command/status
+    uint8_t command;
+    if (ata_drive.multiple_block_count > 1)
+        command = ata_drive.lba48 ? ATA_COMMAND_WRITE_MULTIPLE_EXT : ATA_COMMAND_WRITE_MULTIPLE;
+    else
+        command = ata_drive.lba48 ? ATA_COMMAND_WRITE_SECTORS_EXT : ATA_COMMAND_WRITE_SECTORS;
+    ATA_issue_command(logical_block_address, block_count, command, ata_drive.lba48);
 
-    for (uint32_t i = 0; i < block_count; i++)
+    for (uint32_t i = 0; i < block_count; i += ata_drive.multiple_block_count)
     {
+        uint32_t drq_block_count = block_count - i;
+        if (drq_block_count > ata_drive.multiple_block_count)
+            drq_block_count = ata_drive.multiple_block_count;
+
+        // DRQ block pertama tidak didahului IRQ, block berikutnya menunggu IRQ dari block sebelumnya
+        if (i > 0)
+            ATA_irq_wait();
         ATA_busy_wait();
         ATA_DRQ_wait();
-        for (uint32_t j = 0; j < HALF_BLOCK_SIZE; j++)
-            out16(0x1F0, ((uint16_t *)ptr)[HALF_BLOCK_SIZE * i + j]);
+        for (uint32_t j = 0; j < drq_block_count; j++)
+        {
+            const uint16_t *source = (const uint16_t *)block_segment_pointer(segment, &index, &offset);
+            for (uint32_t k = 0; k < HALF_BLOCK_SIZE; k++)
+                out16(ATA_PRIMARY_DATA, source[k]);
+            offset++;
+        }
+    }
+    // Menunggu IRQ penyelesaian block terakhir
+    ATA_irq_wait();
+    ATA_busy_wait();
+}
+
+// Transfer daftar segment ke / dari LBA berurutan, dipecah seminimal mungkin command
+static void ATA_rw(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address, bool is_read)
+{
+    uint32_t block_count = 0;
+    for (uint32_t i = 0; i < segment_count; i++)
+        block_count += segment[i].block_count;
+
+    uint32_t index = 0;
+    uint32_t offset = 0;
+    while (block_count > 0)
+    {
+        uint32_t count = block_count < ATA_max_block_count() ? block_count : ATA_max_block_count();
+        uint32_t transferred = ata_bm_base ? ATA_DMA_rw(segment, index, offset, logical_block_address, count, is_read) : 0;
+        if (transferred == 0)
+        {
+            // Fallback ke PIO, DMA dimatikan jika controller gagal
+            ata_bm_base = 0;
+            if (is_read)
+                ATA_PIO_read(segment, index, offset, logical_block_address, count);
+            else
+                ATA_PIO_write(segment, index, offset, logical_block_address, count);
+            transferred = count;
+        }
+        block_segment_advance(segment, &index, &offset, transferred);
+        logical_block_address += transferred;
+        block_count -= transferred;
     }
 }
+
+// Vectored read ATA
+static void ATA_read(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    ATA_rw(segment, segment_count, logical_block_address, true);
+}
+
+// Vectored write ATA
+static void ATA_write(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    ATA_rw(segment, segment_count, logical_block_address, false);
+}
+
+// Commit write cache milik drive ke media
+static void ATA_flush(void)
+{
+    uint8_t command = ata_drive.lba48 ? ATA_COMMAND_FLUSH_CACHE_EXT : ATA_COMMAND_FLUSH_CACHE;
+    ATA_issue_command(0, 0, command, false);
+    ATA_irq_wait();
+    ATA_busy_wait();
+}
+
+// Backend yang dipakai read_blocks() / write_blocks(), default ATA primary master
+static struct BlockDevice block_device = {
+    .read = ATA_read,
+    .write = ATA_write,
+    .flush = ATA_flush,
+    .batch_begin = NULL,
+    .batch_end = NULL,
+    .irq_activate = ATA_irq_activate,
+    .isr = ATA_isr,
+    .irq = IRQ_PRIMARY_ATA,
+    .block_count = 0,
+};
+
+void initialize_disk(void)
+{
+    // Urutan prioritas: virtio-blk (paravirtual), AHCI, lalu ATA legacy
+    if (virtio_blk_initialize(&block_device) || ahci_initialize(&block_device))
+        return;
+
+    ATA_identify();
+    ATA_DMA_initialize();
+    block_device.block_count = ata_drive.present ? ata_drive.block_count : 0;
+}
+
+uint8_t disk_irq(void)
+{
+    return block_device.irq;
+}
+
+void disk_irq_activate(void)
+{
+    block_device.irq_activate();
+}
+
+void disk_isr(void)
+{
+    block_device.isr();
+}
+
+void disk_batch_begin(void)
+{
+    if (block_device.batch_begin != NULL)
+        block_device.batch_begin();
+}
+
+void disk_batch_end(void)
+{
+    if (block_device.batch_end != NULL)
+        block_device.batch_end();
+}
+
+// Membaca blok dari disk
+void read_blocks(void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    struct BlockSegment segment = {.ptr = ptr, .block_count = block_count};
+    block_device.read(&segment, 1, logical_block_address);
+}
+
+// Menulis blok data ke disk
+void write_blocks(const void *ptr, uint32_t logical_block_address, uint32_t block_count)
+{
+    struct BlockSegment segment = {.ptr = (void *)ptr, .block_count = block_count};
+    block_device.write(&segment, 1, logical_block_address);
+}
+
+void read_blocks_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    block_device.read(segment, segment_count, logical_block_address);
+}
+
+void write_blocks_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    block_device.write(segment, segment_count, logical_block_address);
+}
+
+void flush_blocks(void)
+{
+    block_device.flush();
+}
+
+uint32_t disk_block_count(void)
+{
+    return block_device.block_count;
+}
@@ -4,16 +4,18 @@
 
 #include "header/cpu/fat32.h"
 #include "header/cpu/disk.h"
+#include "header/cpu/block-cache.h"
 #include "header/stdlib/string.h"
 
 // Global variable
 uint8_t *image_storage;
+size_t image_size;
 uint8_t *file_buffer;
 
 // Membaca blok data 
-void read_blocks(void *ptr, uint32_t logical_block_address, uint8_t block_count)
+void read_blocks(void *ptr, uint32_t logical_block_address, uint32_t block_count)
 {
-    for (int i = 0; i < block_count; i++)
+    for (uint32_t i = 0; i < block_count; i++)
     {
         memcpy(
             (uint8_t *)ptr + BLOCK_SIZE * i,
@@ -23,9 +25,9 @@ void read_blocks(void *ptr, uint32_t logical_block_address, uint8_t block_count)
 }
 
 // Menulis blok data 
-void write_blocks(const void *ptr, uint32_t logical_block_address, uint8_t block_count)
+void write_blocks(const void *ptr, uint32_t logical_block_address, uint32_t block_count)
 {
-    for (int i = 0; i < block_count; i++)
+    for (uint32_t i = 0; i < block_count; i++)
     {
         memcpy(
             image_storage + BLOCK_SIZE * (logical_block_address + i),
@@ -34,6 +36,46 @@ void write_blocks(const void *ptr, uint32_t logical_block_address, uint8_t block
     }
 }
 
+// Membaca satu range blok ke beberapa segment memori
+void read_blocks_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    for (uint32_t i = 0; i < segment_count; i++)
+    {
+        read_blocks(segment[i].ptr, logical_block_address, segment[i].block_count);
+        logical_block_address += segment[i].block_count;
+    }
+}
+
+// Menulis beberapa segment memori ke satu range blok
+void write_blocks_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    for (uint32_t i = 0; i < segment_count; i++)
+    {
+        write_blocks(segment[i].ptr, logical_block_address, segment[i].block_count);
+        logical_block_address += segment[i].block_count;
+    }
+}
+
+// Image berada di memori, tidak ada write cache yang perlu di-commit
+void flush_blocks(void)
+{
+}
+
+// Setiap transfer image langsung selesai, tidak ada command yang diantrikan
+void disk_batch_begin(void)
+{
+}
+
+void disk_batch_end(void)
+{
+}
+
+// Ukuran disk mengikuti ukuran image
+uint32_t disk_block_count(void)
+{
+    return image_size / BLOCK_SIZE;
+}
+
 int main(int argc, char *argv[])
 {
     // Memeriksa jumlah argumen yang diberikan
@@ -43,11 +85,19 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
-    // Membaca storage ke memori, membutuhkan 4 MB memori
-    image_storage = malloc(4 * 1024 * 1024);
-    file_buffer = malloc(4 * 1024 * 1024);
+    // Membaca storage ke memori, memori yang dibutuhkan sama dengan ukuran image
     FILE *fptr = fopen(argv[3], "r");
-    fread(image_storage, 4 * 1024 * 1024, 1, fptr);
+    if (fptr == NULL)
+    {
+        fprintf(stderr, "inserter: cannot open storage %s\n", argv[3]);
+        exit(1);
+    }
+    fseek(fptr, 0, SEEK_END);
+    image_size = ftell(fptr);
+    fseek(fptr, 0, SEEK_SET);
+    image_storage = malloc(image_size);
+    file_buffer = malloc(4 * 1024 * 1024);
+    fread(image_storage, image_size, 1, fptr);
     fclose(fptr);
 
     // Membaca file target, dengan asumsi file kurang dari 4 MiB
@@ -66,7 +116,9 @@ int main(int argc, char *argv[])
     printf("Filename : %s\n", argv[1]);
     printf("Filesize : %ld bytes\n", filesize);
 
-    // FAT32 operations
+    // FAT32 operations, block cache 1 MiB write-back
+    block_cache_initialize(malloc(1024 * 1024), 1024 * 1024);
+    block_cache_set_write_back(true);
     initialize_filesystem_fat32();
     struct FAT32DriverRequest request = {
         .buf = file_buffer,
@@ -101,9 +153,12 @@ int main(int argc, char *argv[])
         puts("Error: Unknown error");
     }
 
+    // Dirty block harus berada di image sebelum image ditulis
+    block_cache_sync();
+
      // Menulis image dalam memori ke asli, overwrite
     fptr = fopen(argv[3], "w");
-    fwrite(image_storage, 4 * 1024 * 1024, 1, fptr);
+    fwrite(image_storage, image_size, 1, fptr);
     fclose(fptr);
 
     return 0;
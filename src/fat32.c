@@ -1,4 +1,5 @@
 #include "header/cpu/fat32.h"
+#include "header/cpu/block-cache.h"
 #include "header/stdlib/string.h"
 #include <stdbool.h>
 #include <stddef.h>
@@ -92,23 +93,507 @@ const uint8_t fs_signature[BLOCK_SIZE] = {
 
 static struct FAT32DriverState fat32_driver_state;
 
+// LBA dari FAT block, FAT cluster pertama berada di FAT_CLUSTER_NUMBER dan sisanya setelah root
+static uint32_t fat32_fat_block_lba(uint32_t block)
+{
+  uint32_t fat_cluster = block / CLUSTER_BLOCK_COUNT;
+  uint32_t cluster_number = fat_cluster == 0 ? FAT_CLUSTER_NUMBER : ROOT_CLUSTER_NUMBER + fat_cluster;
+  return cluster_to_lba(cluster_number) + block % CLUSTER_BLOCK_COUNT;
+}
+
+// Jumlah FAT block yang berisi entry volume
+static uint32_t fat32_fat_block_count(void)
+{
+  return (fat32_driver_state.geometry.cluster_count + FAT32_FAT_ENTRY_PER_BLOCK - 1) / FAT32_FAT_ENTRY_PER_BLOCK;
+}
+
+// Mengambil slot window untuk FAT block, block di-page in melalui block cache jika belum resident
+static struct FAT32FATWindowSlot *fat32_fat_window(uint32_t block)
+{
+  struct FAT32FATWindowSlot *slot = &fat32_driver_state.fat_window[block % FAT32_FAT_WINDOW_SIZE];
+  if (slot->valid && slot->block == block)
+    return slot;
+
+  // Slot dirty ditulis ke block cache sebelum digunakan block lain
+  if (slot->valid && slot->dirty)
+    block_cache_write_blocks(slot->entry, fat32_fat_block_lba(slot->block), 1);
+  block_cache_read_blocks(slot->entry, fat32_fat_block_lba(block), 1);
+  slot->block = block;
+  slot->valid = true;
+  slot->dirty = false;
+  return slot;
+}
+
+// Membaca entry FAT, cluster di luar volume dianggap kosong
+static uint32_t fat32_get_cluster_map(uint32_t cluster_number)
+{
+  if (cluster_number >= fat32_driver_state.geometry.cluster_count)
+    return FAT32_FAT_EMPTY_ENTRY;
+  return fat32_fat_window(cluster_number / FAT32_FAT_ENTRY_PER_BLOCK)->entry[cluster_number % FAT32_FAT_ENTRY_PER_BLOCK];
+}
+
+// Membangun free bitmap untuk satu block FAT, dilewati jika sudah dibangun
+static void fat32_scan_fat_block(uint32_t block)
+{
+  if (fat32_driver_state.free_bitmap_valid_mask[block / 32] & (1u << (block % 32)))
+    return;
+
+  struct FAT32FATWindowSlot *slot = fat32_fat_window(block);
+  for (uint32_t i = 0; i < FAT32_FAT_ENTRY_PER_BLOCK; i++)
+  {
+    uint32_t cluster_number = block * FAT32_FAT_ENTRY_PER_BLOCK + i;
+    if (slot->entry[i] == FAT32_FAT_EMPTY_ENTRY && cluster_number < fat32_driver_state.geometry.cluster_count)
+      fat32_driver_state.free_bitmap[cluster_number / 32] |= 1u << (cluster_number % 32);
+    else
+      fat32_driver_state.free_bitmap[cluster_number / 32] &= ~(1u << (cluster_number % 32));
+  }
+  fat32_driver_state.free_bitmap_valid_mask[block / 32] |= 1u << (block % 32);
+}
+
+// Membangun seluruh free bitmap dan menghitung ulang jumlah cluster kosong
+static void fat32_scan_fat(void)
+{
+  memset(fat32_driver_state.free_bitmap_valid_mask, 0, sizeof(fat32_driver_state.free_bitmap_valid_mask));
+  fat32_driver_state.free_cluster_count = 0;
+  for (uint32_t block = 0; block < fat32_fat_block_count(); block++)
+    fat32_scan_fat_block(block);
+  for (uint32_t i = 0; i < fat32_driver_state.geometry.cluster_count; i++)
+    if (fat32_driver_state.free_bitmap[i / 32] & (1u << (i % 32)))
+      fat32_driver_state.free_cluster_count++;
+  fat32_driver_state.next_free_cluster = ROOT_CLUSTER_NUMBER + 1;
+  fat32_driver_state.fsinfo_dirty = true;
+}
+
+// Mengubah entry FAT pada window dan menandai FAT block tersebut dirty
+static void fat32_set_cluster_map(uint32_t cluster_number, uint32_t value)
+{
+  uint32_t block = cluster_number / FAT32_FAT_ENTRY_PER_BLOCK;
+  struct FAT32FATWindowSlot *slot = fat32_fat_window(block);
+  uint32_t index = cluster_number % FAT32_FAT_ENTRY_PER_BLOCK;
+  bool was_free = slot->entry[index] == FAT32_FAT_EMPTY_ENTRY;
+  bool is_free = value == FAT32_FAT_EMPTY_ENTRY;
+  slot->entry[index] = value;
+  slot->dirty = true;
+
+  // Free count & bitmap mengikuti perubahan status kosong entry
+  if (was_free == is_free)
+    return;
+  if (is_free)
+    fat32_driver_state.free_cluster_count++;
+  else
+    fat32_driver_state.free_cluster_count--;
+  if (fat32_driver_state.free_bitmap_valid_mask[block / 32] & (1u << (block % 32)))
+    fat32_driver_state.free_bitmap[cluster_number / 32] ^= 1u << (cluster_number % 32);
+  fat32_driver_state.fsinfo_dirty = true;
+}
+
+// True jika cluster kosong, free bitmap block FAT yang berisi cluster dibangun terlebih dahulu
+static bool fat32_is_free_cluster(uint32_t cluster_number)
+{
+  fat32_scan_fat_block(cluster_number / FAT32_FAT_ENTRY_PER_BLOCK);
+  return fat32_driver_state.free_bitmap[cluster_number / 32] & (1u << (cluster_number % 32));
+}
+
+// Mencari run cluster kosong kontigu mulai dari next free hint (wrap-around).
+// Run pertama dengan panjang >= want dipilih, jika tidak ada maka run terpanjang dalam
+// FAT32_FREE_RUN_SEARCH_WINDOW cluster setelah cluster kosong pertama. Return panjang run (<= want)
+static uint32_t fat32_find_free_run(uint32_t want, uint32_t *run_start)
+{
+  uint32_t cluster_count = fat32_driver_state.geometry.cluster_count;
+  uint32_t hint = fat32_driver_state.next_free_cluster % cluster_count;
+  uint32_t best_start = 0, best_length = 0;
+  uint32_t searched = 0;
+  for (uint8_t segment = 0; segment < 2; segment++)
+  {
+    uint32_t low = segment == 0 ? hint : 0;
+    uint32_t high = segment == 0 ? cluster_count : hint;
+    uint32_t start = 0, length = 0;
+    for (uint32_t i = low; i < high; i++)
+    {
+      // Word bitmap tanpa cluster kosong dilewati sekaligus
+      if (length == 0 && i % 32 == 0 && i + 32 <= high)
+      {
+        fat32_scan_fat_block(i / FAT32_FAT_ENTRY_PER_BLOCK);
+        if (fat32_driver_state.free_bitmap[i / 32] == 0)
+        {
+          if (best_length > 0 && (searched += 32) >= FAT32_FREE_RUN_SEARCH_WINDOW)
+            break;
+          i += 31;
+          continue;
+        }
+      }
+
+      if (fat32_is_free_cluster(i))
+      {
+        if (length++ == 0)
+          start = i;
+        if (length == want)
+        {
+          *run_start = start;
+          return length;
+        }
+        continue;
+      }
+      if (length > best_length)
+      {
+        best_start = start;
+        best_length = length;
+      }
+      length = 0;
+      if (best_length > 0 && ++searched >= FAT32_FREE_RUN_SEARCH_WINDOW)
+        break;
+    }
+    if (length > best_length)
+    {
+      best_start = start;
+      best_length = length;
+    }
+    if (best_length > 0 && searched >= FAT32_FREE_RUN_SEARCH_WINDOW)
+      break;
+  }
+  *run_start = best_start;
+  return best_length;
+}
+
+// Membebaskan seluruh cluster pada chain mulai dari cluster_number
+static void fat32_free_chain(uint32_t cluster_number)
+{
+  while (cluster_number != 0 && cluster_number != FAT32_FAT_END_OF_FILE)
+  {
+    uint32_t next_cluster_number = fat32_get_cluster_map(cluster_number);
+    fat32_set_cluster_map(cluster_number, FAT32_FAT_EMPTY_ENTRY);
+    cluster_number = next_cluster_number;
+  }
+}
+
+// Mengalokasikan cluster_count cluster dengan mengutamakan run kontigu, lalu disambungkan setelah last_cluster
+// (0 untuk chain baru). Return cluster pertama yang dialokasikan, 0 jika cluster kosong tidak cukup
+static uint32_t fat32_allocate_chain(uint32_t last_cluster, uint32_t cluster_count)
+{
+  if (cluster_count == 0 || fat32_driver_state.free_cluster_count < cluster_count)
+    return 0;
+
+  uint32_t first_cluster = 0;
+  uint32_t previous = last_cluster;
+  while (cluster_count > 0)
+  {
+    uint32_t run_start;
+    uint32_t run_length = fat32_find_free_run(cluster_count, &run_start);
+    if (run_length == 0)
+    {
+      // Free count dari FSInfo tidak sesuai dengan FAT, chain yang sudah terambil dikembalikan
+      fat32_driver_state.free_cluster_count = 0;
+      fat32_driver_state.fsinfo_dirty = true;
+      fat32_free_chain(first_cluster);
+      if (last_cluster != 0)
+        fat32_set_cluster_map(last_cluster, FAT32_FAT_END_OF_FILE);
+      return 0;
+    }
+
+    for (uint32_t i = run_start; i < run_start + run_length; i++)
+    {
+      fat32_set_cluster_map(i, FAT32_FAT_END_OF_FILE);
+      if (previous != 0)
+        fat32_set_cluster_map(previous, i);
+      if (first_cluster == 0)
+        first_cluster = i;
+      previous = i;
+    }
+    fat32_driver_state.next_free_cluster = run_start + run_length;
+    cluster_count -= run_length;
+  }
+  return first_cluster;
+}
+
+// Panjang run kontigu pada chain mulai dari cluster_number, maksimal max_length
+static uint32_t fat32_chain_run_length(uint32_t cluster_number, uint32_t max_length)
+{
+  uint32_t length = 1;
+  while (length < max_length &&
+         fat32_get_cluster_map(cluster_number + length - 1) == cluster_number + length)
+    length++;
+  return length;
+}
+
+// Jumlah cluster untuk menyimpan size byte
+static uint32_t fat32_cluster_count(uint32_t size)
+{
+  return (size + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+}
+
+// Menambahkan run pada chain mulai dari cluster_number ke akhir extent map, run kontigu digabung
+static void fat32_extent_extend(struct FAT32ExtentMap *map, uint32_t cluster_number)
+{
+  while (cluster_number != FAT32_FAT_END_OF_FILE && cluster_number != FAT32_FAT_EMPTY_ENTRY)
+  {
+    uint32_t length = fat32_chain_run_length(cluster_number, FAT32_MAX_CLUSTER_COUNT);
+    struct FAT32Extent *last = map->extent_count > 0 ? &map->extent[map->extent_count - 1] : NULL;
+    if (last != NULL && last->cluster_number + last->length == cluster_number)
+      last->length += length;
+    else if (map->extent_count == FAT32_EXTENT_MAP_SIZE)
+    {
+      // Extent list penuh, sisa chain diikuti lewat FAT saat lookup
+      map->complete = false;
+      return;
+    }
+    else
+    {
+      map->extent[map->extent_count].file_cluster_index = map->cluster_count;
+      map->extent[map->extent_count].cluster_number = cluster_number;
+      map->extent[map->extent_count].length = length;
+      map->extent_count++;
+    }
+    map->cluster_count += length;
+    cluster_number = fat32_get_cluster_map(cluster_number + length - 1);
+  }
+  map->complete = true;
+}
+
+// Extent map milik file dengan cluster pertama first_cluster, dibangun dari chain saat pertama kali diakses
+static struct FAT32ExtentMap *fat32_extent_map(uint32_t first_cluster)
+{
+  struct FAT32ExtentMap *map = &fat32_driver_state.extent_map[first_cluster % FAT32_EXTENT_MAP_COUNT];
+  if (!map->valid || map->first_cluster != first_cluster)
+  {
+    map->first_cluster = first_cluster;
+    map->valid = true;
+    map->extent_count = 0;
+    map->cluster_count = 0;
+    map->readahead_next = 0;
+    map->readahead_end = 0;
+    map->readahead_window = FAT32_READAHEAD_MIN;
+    fat32_extent_extend(map, first_cluster);
+  }
+  return map;
+}
+
+// Membuang extent map file, dipanggil saat chain dibebaskan
+static void fat32_extent_invalidate(uint32_t first_cluster)
+{
+  struct FAT32ExtentMap *map = &fat32_driver_state.extent_map[first_cluster % FAT32_EXTENT_MAP_COUNT];
+  if (map->first_cluster == first_cluster)
+    map->valid = false;
+}
+
+// Cluster ke-cluster_index pada file dengan binary search atas extent map,
+// FAT32_FAT_END_OF_FILE jika chain lebih pendek
+static uint32_t fat32_extent_lookup(uint32_t first_cluster, uint32_t cluster_index)
+{
+  struct FAT32ExtentMap *map = fat32_extent_map(first_cluster);
+  if (cluster_index >= map->cluster_count)
+  {
+    if (map->complete)
+      return FAT32_FAT_END_OF_FILE;
+    struct FAT32Extent *last = &map->extent[map->extent_count - 1];
+    uint32_t cluster_number = last->cluster_number + last->length - 1;
+    for (uint32_t i = map->cluster_count - 1; i < cluster_index && cluster_number != FAT32_FAT_END_OF_FILE; i++)
+      cluster_number = fat32_get_cluster_map(cluster_number);
+    return cluster_number;
+  }
+
+  // Extent terakhir dengan file_cluster_index <= cluster_index
+  uint16_t low = 0;
+  uint16_t high = map->extent_count - 1;
+  while (low < high)
+  {
+    uint16_t middle = (low + high + 1) / 2;
+    if (map->extent[middle].file_cluster_index <= cluster_index)
+      low = middle;
+    else
+      high = middle - 1;
+  }
+  return map->extent[low].cluster_number + (cluster_index - map->extent[low].file_cluster_index);
+}
+
+// Prefetch cluster [cluster_index, end_index) milik file ke block cache, satu command untuk setiap run kontigu
+static void fat32_prefetch_clusters(uint32_t first_cluster, uint32_t cluster_index, uint32_t end_index)
+{
+  while (cluster_index < end_index)
+  {
+    uint32_t cluster_number = fat32_extent_lookup(first_cluster, cluster_index);
+    if (cluster_number == FAT32_FAT_END_OF_FILE || cluster_number == FAT32_FAT_EMPTY_ENTRY)
+      return;
+    uint32_t run_length = fat32_chain_run_length(cluster_number, end_index - cluster_index);
+    block_cache_prefetch(cluster_to_lba(cluster_number), cluster_to_lba(run_length));
+    cluster_index += run_length;
+  }
+}
+
+// Mendeteksi pembacaan berurutan [cluster_index, cluster_index + cluster_count) dan menjaga window readahead di depannya,
+// dipanggil sebelum cluster dibaca sehingga cluster yang diminta ikut terbawa command prefetch
+static void fat32_readahead(uint32_t first_cluster, uint32_t cluster_index, uint32_t cluster_count)
+{
+  struct FAT32ExtentMap *map = fat32_extent_map(first_cluster);
+  // Pembacaan kecil berikutnya bisa masih berada di cluster terakhir pembacaan sebelumnya
+  bool sequential = cluster_index == map->readahead_next || cluster_index + 1 == map->readahead_next;
+  bool bypass = cluster_to_lba(cluster_count) > BLOCK_CACHE_BYPASS_BLOCK_COUNT;
+  if (!sequential || bypass)
+  {
+    // Akses acak, cluster prefetch yang belum dibaca terbuang sehingga window dikecilkan.
+    // Transfer besar tidak lewat cache sehingga tidak perlu prefetch
+    if (!sequential && map->readahead_end > map->readahead_next && map->readahead_window > FAT32_READAHEAD_MIN)
+      map->readahead_window /= 2;
+    map->readahead_next = cluster_index + cluster_count;
+    map->readahead_end = map->readahead_next;
+    return;
+  }
+
+  // Pembacaan mengenai cluster hasil prefetch, window diperbesar
+  if (cluster_index < map->readahead_end && cluster_index + cluster_count > map->readahead_next &&
+      map->readahead_window < FAT32_READAHEAD_MAX)
+    map->readahead_window *= 2;
+  if (map->readahead_end < cluster_index)
+    map->readahead_end = cluster_index;
+  map->readahead_next = cluster_index + cluster_count;
+
+  // Prefetch baru dimulai saat sisa window tinggal setengah, sehingga satu command membawa banyak cluster
+  if (map->readahead_end >= map->readahead_next && map->readahead_end - map->readahead_next > map->readahead_window / 2)
+    return;
+  uint32_t end_index = map->readahead_next + map->readahead_window;
+  if (map->complete && end_index > map->cluster_count)
+    end_index = map->cluster_count;
+  if (end_index > map->readahead_end)
+  {
+    fat32_prefetch_clusters(first_cluster, map->readahead_end, end_index);
+    map->readahead_end = end_index;
+  }
+}
+
+// Cluster terakhir dan jumlah cluster pada chain file, diambil dari extent map jika lengkap
+static uint32_t fat32_chain_last(uint32_t first_cluster, uint32_t *cluster_count)
+{
+  struct FAT32ExtentMap *map = fat32_extent_map(first_cluster);
+  if (map->complete)
+  {
+    struct FAT32Extent *last = &map->extent[map->extent_count - 1];
+    *cluster_count = map->cluster_count;
+    return last->cluster_number + last->length - 1;
+  }
+
+  uint32_t last_cluster = first_cluster;
+  *cluster_count = 1;
+  while (fat32_get_cluster_map(last_cluster) != FAT32_FAT_END_OF_FILE)
+  {
+    last_cluster = fat32_get_cluster_map(last_cluster);
+    (*cluster_count)++;
+  }
+  return last_cluster;
+}
+
+// Memperpanjang chain file hingga required cluster, extent map ikut diperbarui. False jika cluster tidak cukup
+static bool fat32_extend_file(uint32_t first_cluster, uint32_t required)
+{
+  uint32_t cluster_count;
+  uint32_t last_cluster = fat32_chain_last(first_cluster, &cluster_count);
+  if (cluster_count >= required)
+    return true;
+
+  // Cluster setelah cluster terakhir diutamakan agar file tetap kontigu
+  fat32_driver_state.next_free_cluster = last_cluster + 1;
+  uint32_t new_cluster = fat32_allocate_chain(last_cluster, required - cluster_count);
+  if (new_cluster == 0)
+    return false;
+  struct FAT32ExtentMap *map = fat32_extent_map(first_cluster);
+  if (map->complete)
+    fat32_extent_extend(map, new_cluster);
+  else
+    map->valid = false;
+  return true;
+}
+
+// Membaca free count & next free hint dari FSInfo, false jika FSInfo tidak valid
+static bool fat32_load_fsinfo(void)
+{
+  struct FAT32FSInfo fsinfo;
+  block_cache_read_blocks(&fsinfo, FSINFO_SECTOR, 1);
+  if (fsinfo.lead_signature != FSINFO_LEAD_SIGNATURE ||
+      fsinfo.struct_signature != FSINFO_STRUCT_SIGNATURE ||
+      fsinfo.trail_signature != FSINFO_TRAIL_SIGNATURE ||
+      fsinfo.free_count == FSINFO_UNKNOWN || fsinfo.free_count > fat32_driver_state.geometry.cluster_count)
+    return false;
+
+  fat32_driver_state.free_cluster_count = fsinfo.free_count;
+  fat32_driver_state.next_free_cluster = fsinfo.next_free == FSINFO_UNKNOWN ? ROOT_CLUSTER_NUMBER + 1 : fsinfo.next_free;
+  memset(fat32_driver_state.free_bitmap_valid_mask, 0, sizeof(fat32_driver_state.free_bitmap_valid_mask));
+  fat32_driver_state.fsinfo_dirty = false;
+  return true;
+}
+
+// Menulis free count & next free hint ke FSInfo
+static void fat32_store_fsinfo(void)
+{
+  struct FAT32FSInfo fsinfo;
+  memset(&fsinfo, 0, sizeof(struct FAT32FSInfo));
+  fsinfo.lead_signature = FSINFO_LEAD_SIGNATURE;
+  fsinfo.struct_signature = FSINFO_STRUCT_SIGNATURE;
+  fsinfo.free_count = fat32_driver_state.free_cluster_count;
+  fsinfo.next_free = fat32_driver_state.next_free_cluster;
+  fsinfo.trail_signature = FSINFO_TRAIL_SIGNATURE;
+  block_cache_write_blocks(&fsinfo, FSINFO_SECTOR, 1);
+  fat32_driver_state.fsinfo_dirty = false;
+}
+
+// Menulis FAT block yang dirty pada window ke block cache, dipanggil satu kali di akhir setiap operasi
+static void fat32_flush_fat(void)
+{
+  for (uint32_t i = 0; i < FAT32_FAT_WINDOW_SIZE; i++)
+  {
+    struct FAT32FATWindowSlot *slot = &fat32_driver_state.fat_window[i];
+    if (!slot->valid || !slot->dirty)
+      continue;
+    block_cache_write_blocks(slot->entry, fat32_fat_block_lba(slot->block), 1);
+    slot->dirty = false;
+  }
+
+  if (fat32_driver_state.fsinfo_dirty)
+    fat32_store_fsinfo();
+}
+
+uint32_t fat32_get_free_cluster_count(void)
+{
+  return fat32_driver_state.free_cluster_count;
+}
+
 // Fungsi untuk membuat FAT32 file system
 void create_fat32(void)
 {
-  // Menulis file system signature ke boot sector
-  write_blocks(fs_signature, BOOT_SECTOR, 1);
+  // Ukuran volume dari disk, disk yang tidak diketahui ukurannya menggunakan satu FAT cluster
+  uint32_t cluster_count = disk_block_count() / CLUSTER_BLOCK_COUNT;
+  if (cluster_count > FAT32_MAX_CLUSTER_COUNT)
+    cluster_count = FAT32_MAX_CLUSTER_COUNT;
+  if (cluster_count < CLUSTER_MAP_SIZE)
+    cluster_count = CLUSTER_MAP_SIZE;
+  struct FAT32Geometry *geometry = &fat32_driver_state.geometry;
+  memset(geometry, 0, sizeof(struct FAT32Geometry));
+  geometry->cluster_count = cluster_count;
+  geometry->fat_cluster_count = (cluster_count + FAT32_FAT_ENTRY_PER_CLUSTER - 1) / FAT32_FAT_ENTRY_PER_CLUSTER;
+
+  // Menulis file system signature dan geometry ke boot sector
+  uint8_t boot_sector[BLOCK_SIZE];
+  memcpy(boot_sector, fs_signature, BLOCK_SIZE);
+  memcpy(boot_sector + FAT32_GEOMETRY_OFFSET, geometry, sizeof(struct FAT32Geometry));
+  block_cache_write_blocks(boot_sector, BOOT_SECTOR, 1);
 
-  // Menginsialisasi File Allocation Table dengan reserved values
-  struct FAT32FileAllocationTable *fat = &fat32_driver_state.fat_table;
-  fat->cluster_map[0] = CLUSTER_0_VALUE;
-  fat->cluster_map[1] = CLUSTER_1_VALUE;
-  for (int i = 2; i < CLUSTER_MAP_SIZE; i++)
+  // Menginsialisasi File Allocation Table dengan reserved values, clusters yang tidak digunakan diinisialisasi ke 0
+  struct FAT32FileAllocationTable *fat = (struct FAT32FileAllocationTable *)&fat32_driver_state.cluster_buf;
+  for (uint32_t k = 0; k < geometry->fat_cluster_count; k++)
   {
-    fat->cluster_map[i] = 0; // Clusters yang tidak digunakan diinisialisasi ke 0
+    memset(fat, 0, sizeof(struct FAT32FileAllocationTable));
+    write_clusters(fat, k == 0 ? FAT_CLUSTER_NUMBER : ROOT_CLUSTER_NUMBER + k, 1);
   }
+  memset(fat32_driver_state.fat_window, 0, sizeof(fat32_driver_state.fat_window));
+
+  fat32_set_cluster_map(0, CLUSTER_0_VALUE);
+  fat32_set_cluster_map(1, CLUSTER_1_VALUE);
+  // Root directory menempati satu cluster, FAT cluster berikutnya ditandai terpakai
+  fat32_set_cluster_map(ROOT_CLUSTER_NUMBER, FAT32_FAT_END_OF_FILE);
+  for (uint32_t k = 1; k < geometry->fat_cluster_count; k++)
+    fat32_set_cluster_map(ROOT_CLUSTER_NUMBER + k, FAT32_FAT_END_OF_FILE);
 
   // Menulis File Allocation Table ke disk
-  write_clusters(fat, FAT_CLUSTER_NUMBER, 1);
+  fat32_scan_fat();
+  fat32_driver_state.next_free_cluster = ROOT_CLUSTER_NUMBER + geometry->fat_cluster_count;
+  fat32_flush_fat();
 
   // Menginisialisasi root directory
   struct FAT32DirectoryTable *dir = &fat32_driver_state.dir_table_buf;
@@ -122,20 +607,40 @@ void create_fat32(void)
 bool is_empty_storage(void)
 {
   uint8_t boot_sector[BLOCK_SIZE];
-  read_blocks(boot_sector, BOOT_SECTOR, 1);
-  return memcmp(boot_sector, fs_signature, BLOCK_SIZE);
+  block_cache_read_blocks(boot_sector, BOOT_SECTOR, 1);
+  return memcmp(boot_sector, fs_signature, FAT32_GEOMETRY_OFFSET) ||
+         memcmp(boot_sector + FAT32_GEOMETRY_OFFSET + FAT32_GEOMETRY_SIZE,
+                fs_signature + FAT32_GEOMETRY_OFFSET + FAT32_GEOMETRY_SIZE,
+                BLOCK_SIZE - FAT32_GEOMETRY_OFFSET - FAT32_GEOMETRY_SIZE);
 }
 
 // Menginisialisasi FAT32 File System
 void initialize_filesystem_fat32(void)
 {
+  memset(fat32_driver_state.fat_window, 0, sizeof(fat32_driver_state.fat_window));
+  memset(fat32_driver_state.directory_hint, 0, sizeof(fat32_driver_state.directory_hint));
+  memset(fat32_driver_state.dentry_cache, 0, sizeof(fat32_driver_state.dentry_cache));
+  memset(fat32_driver_state.extent_map, 0, sizeof(fat32_driver_state.extent_map));
+  memset(fat32_driver_state.open_file, 0, sizeof(fat32_driver_state.open_file));
   if (is_empty_storage())
   {
     create_fat32();
   }
   else
   {
-    read_clusters(&fat32_driver_state.fat_table, FAT_CLUSTER_NUMBER, 1);
+    // Geometry kosong berarti image lama dengan satu FAT cluster
+    uint8_t boot_sector[BLOCK_SIZE];
+    block_cache_read_blocks(boot_sector, BOOT_SECTOR, 1);
+    memcpy(&fat32_driver_state.geometry, boot_sector + FAT32_GEOMETRY_OFFSET, sizeof(struct FAT32Geometry));
+    if (fat32_driver_state.geometry.cluster_count == 0)
+    {
+      fat32_driver_state.geometry.cluster_count = CLUSTER_MAP_SIZE;
+      fat32_driver_state.geometry.fat_cluster_count = 1;
+    }
+
+    // Image lama tanpa FSInfo, free count dihitung dari FAT dan FSInfo ditulis pada operasi berikutnya
+    if (!fat32_load_fsinfo())
+      fat32_scan_fat();
   }
 }
 
@@ -144,23 +649,23 @@ uint32_t cluster_to_lba(uint32_t cluster) { return cluster * CLUSTER_BLOCK_COUNT
 
 // Menulis clusters ke disk
 void write_clusters(const void *ptr, uint32_t cluster_number,
-                    uint8_t cluster_count)
+                    uint32_t cluster_count)
 {
   uint32_t block_number = cluster_to_lba(cluster_number);
 
-  uint8_t block_count = cluster_to_lba(cluster_count);
+  uint32_t block_count = cluster_to_lba(cluster_count);
 
-  write_blocks(ptr, block_number, block_count);
+  block_cache_write_blocks(ptr, block_number, block_count);
 }
 
 // Membaca clusters dari disk
-void read_clusters(void *ptr, uint32_t cluster_number, uint8_t cluster_count)
+void read_clusters(void *ptr, uint32_t cluster_number, uint32_t cluster_count)
 {
   uint32_t block_number = cluster_to_lba(cluster_number);
 
-  uint8_t block_count = cluster_to_lba(cluster_count);
+  uint32_t block_count = cluster_to_lba(cluster_count);
 
-  read_blocks(ptr, block_number, block_count);
+  block_cache_read_blocks(ptr, block_number, block_count);
 }
 
 // Menginisialisasi Directory Table
@@ -176,6 +681,13 @@ void init_directory_table(struct FAT32DirectoryTable *dir_table, char *name,
   entry->attribute = ATTR_SUBDIRECTORY;
   entry->cluster_low = parent_dir_cluster & 0xFFFF;
   entry->cluster_high = (parent_dir_cluster >> 16) & 0xFFFF;
+
+  // Entry-1 ".." menunjuk parent directory, digunakan oleh resolve_path()
+  struct FAT32DirectoryEntry *parent = &dir_table->table[1];
+  memcpy(parent->name, "..", 2);
+  parent->attribute = ATTR_SUBDIRECTORY;
+  parent->cluster_low = parent_dir_cluster & 0xFFFF;
+  parent->cluster_high = (parent_dir_cluster >> 16) & 0xFFFF;
 }
 
 // Membulatkan floating-point number ke bilangan integer berikutnya
@@ -186,131 +698,291 @@ uint8_t ceil(float n)
   return (int)n + 1;
 }
 
-// Membaca file dari FAT32 file system
-int8_t read(struct FAT32DriverRequest request)
+// Cluster pertama dari directory entry
+static uint32_t fat32_entry_cluster(const struct FAT32DirectoryEntry *entry)
+{
+  return ((uint32_t)entry->cluster_high << 16) | entry->cluster_low;
+}
+
+// True jika cluster merupakan cluster pertama sebuah directory (entry-0 menunjuk dirinya sendiri)
+static bool fat32_is_directory(uint32_t cluster_number)
+{
+  if (cluster_number < ROOT_CLUSTER_NUMBER || fat32_get_cluster_map(cluster_number) == FAT32_FAT_EMPTY_ENTRY)
+    return false;
+
+  struct FAT32DirectoryEntry first_block[BLOCK_SIZE / sizeof(struct FAT32DirectoryEntry)];
+  block_cache_read_blocks(first_block, cluster_to_lba(cluster_number), 1);
+  return (first_block[0].attribute & ATTR_SUBDIRECTORY) && fat32_entry_cluster(&first_block[0]) == cluster_number;
+}
+
+// Membaca entry-0 (directory itu sendiri) dan cluster parent dari entry-1, parent 0 jika tidak diketahui
+static void fat32_read_directory_self(uint32_t cluster_number, struct FAT32DirectoryEntry *self, uint32_t *parent_cluster)
+{
+  struct FAT32DirectoryEntry first_block[BLOCK_SIZE / sizeof(struct FAT32DirectoryEntry)];
+  block_cache_read_blocks(first_block, cluster_to_lba(cluster_number), 1);
+  *self = first_block[0];
+  // Directory dari versi lama tidak memiliki entry-1
+  if (parent_cluster != NULL)
+    *parent_cluster = (first_block[1].attribute & ATTR_SUBDIRECTORY) ? fat32_entry_cluster(&first_block[1]) : 0;
+}
+
+// Slot pertama yang dapat digunakan pada cluster ke-cluster_index, entry-0 dan entry-1 hanya ada di cluster pertama
+static uint8_t fat32_directory_first_slot(uint32_t cluster_index)
+{
+  return cluster_index == 0 ? FAT32_DIRECTORY_RESERVED_ENTRY_COUNT : 0;
+}
+
+// Slot dentry cache untuk (directory_cluster, key), hash FNV-1a
+static struct FAT32DentryCacheEntry *fat32_dentry_slot(uint32_t directory_cluster, const char *key)
+{
+  uint32_t hash = 2166136261u;
+  for (uint8_t i = 0; i < 4; i++)
+    hash = (hash ^ ((directory_cluster >> (8 * i)) & 0xFF)) * 16777619u;
+  for (uint8_t i = 0; i < FAT32_DENTRY_NAME_SIZE; i++)
+    hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+  return &fat32_driver_state.dentry_cache[hash & (FAT32_DENTRY_CACHE_SIZE - 1)];
+}
+
+// Menyimpan hasil lookup ke dentry cache, entry NULL untuk negative entry (nama tidak ada)
+static void fat32_dentry_store(uint32_t directory_cluster, const char *key,
+                               const struct FAT32DirectoryPosition *position, const struct FAT32DirectoryEntry *entry)
 {
-  // Mengecek jika parent cluster number bukan end of file marker
-  if (fat32_driver_state.fat_table.cluster_map[request.parent_cluster_number] != FAT32_FAT_END_OF_FILE)
+  struct FAT32DentryCacheEntry *dentry = fat32_dentry_slot(directory_cluster, key);
+  dentry->directory_cluster = directory_cluster;
+  memcpy(dentry->name, key, FAT32_DENTRY_NAME_SIZE);
+  dentry->valid = true;
+  dentry->negative = entry == NULL;
+  if (entry != NULL)
   {
-    return 2;
+    dentry->position = *position;
+    dentry->entry = *entry;
   }
+}
 
-  // Menginisalisasi struktur sebuah directory table
-  struct FAT32DirectoryTable dir_table;
-  memset(&dir_table, 0, CLUSTER_SIZE);
+// Membuang seluruh dentry milik directory, dipanggil saat cluster directory dibuat atau dihapus
+static void fat32_dentry_purge_directory(uint32_t directory_cluster)
+{
+  for (uint32_t i = 0; i < FAT32_DENTRY_CACHE_SIZE; i++)
+    if (fat32_driver_state.dentry_cache[i].directory_cluster == directory_cluster)
+      fat32_driver_state.dentry_cache[i].valid = false;
+}
 
-  // Membaca directory table dari disk
-  read_clusters(&dir_table, request.parent_cluster_number, 1);
+// Mencari entry dengan name & ext di seluruh cluster directory, dentry cache diperiksa lebih dulu.
+// Jika ditemukan, position dan entry terisi
+static bool fat32_find_entry(uint32_t directory_cluster, const char *name, const char *ext,
+                             struct FAT32DirectoryPosition *position, struct FAT32DirectoryEntry *entry)
+{
+  char key[FAT32_DENTRY_NAME_SIZE];
+  memcpy(key, name, 8);
+  memcpy(key + 8, ext, 3);
 
-  for (uint8_t i = 0; i < 64; i++)
+  struct FAT32DentryCacheEntry *dentry = fat32_dentry_slot(directory_cluster, key);
+  if (dentry->valid && dentry->directory_cluster == directory_cluster && !memcmp(dentry->name, key, FAT32_DENTRY_NAME_SIZE))
   {
-    struct FAT32DirectoryEntry dir_entry = dir_table.table[i];
+    if (dentry->negative)
+      return false;
+    *position = dentry->position;
+    *entry = dentry->entry;
+    return true;
+  }
 
-    // Mengecek apakah entry sesuai dengan nama dan ekstensi requested file
-    if (!memcmp(&dir_entry.name, &request.name, 8) && !memcmp(&dir_entry.ext, &request.ext, 3))
+  uint32_t cluster_number = directory_cluster;
+  uint32_t cluster_index = 0;
+  while (cluster_number != FAT32_FAT_END_OF_FILE && cluster_number != FAT32_FAT_EMPTY_ENTRY)
+  {
+    read_clusters(&fat32_driver_state.dir_table_buf, cluster_number, 1);
+    for (uint8_t i = fat32_directory_first_slot(cluster_index); i < FAT32_DIRECTORY_ENTRY_COUNT; i++)
     {
-      // Mengecek apakah entry merupakan directory
-      if (dir_entry.attribute == 0x10)
+      struct FAT32DirectoryEntry *candidate = &fat32_driver_state.dir_table_buf.table[i];
+      if (candidate->user_attribute == UATTR_NOT_EMPTY && !memcmp(candidate->name, key, FAT32_DENTRY_NAME_SIZE))
       {
-        return 1;
+        position->cluster_number = cluster_number;
+        position->cluster_index = cluster_index;
+        position->slot = i;
+        *entry = *candidate;
+        fat32_dentry_store(directory_cluster, key, position, entry);
+        return true;
       }
+    }
+    cluster_number = fat32_get_cluster_map(cluster_number);
+    cluster_index++;
+  }
+  fat32_dentry_store(directory_cluster, key, NULL, NULL);
+  return false;
+}
 
-      // Mengecek apakah kapasitas buffer size cukup untuk menyimpan file data
-      if ((request.buffer_size / CLUSTER_SIZE) < ceil(dir_entry.filesize / (float)CLUSTER_SIZE))
-      {
-        return -1;
-      }
+// Hint slot kosong milik directory, hint dari directory lain di slot yang sama diganti
+static struct FAT32DirectorySlotHint *fat32_directory_hint(uint32_t directory_cluster)
+{
+  struct FAT32DirectorySlotHint *hint = &fat32_driver_state.directory_hint[directory_cluster % FAT32_DIRECTORY_HINT_COUNT];
+  if (hint->directory_cluster != directory_cluster)
+  {
+    hint->directory_cluster = directory_cluster;
+    hint->position.cluster_number = directory_cluster;
+    hint->position.cluster_index = 0;
+    hint->position.slot = FAT32_DIRECTORY_RESERVED_ENTRY_COUNT;
+  }
+  return hint;
+}
 
-      // Membaca file data clusters dari disk
-      uint32_t current_cluster = (dir_entry.cluster_high << 16) | dir_entry.cluster_low;
-      uint32_t clusters_read = 0;
-      while (current_cluster != FAT32_FAT_END_OF_FILE)
+// Mencari slot kosong mulai dari hint, directory diperpanjang satu cluster jika penuh.
+// dir_table_buf berisi cluster tempat slot berada. Return false jika cluster kosong tidak cukup
+static bool fat32_find_free_slot(uint32_t directory_cluster, struct FAT32DirectoryPosition *position)
+{
+  // Semua slot sebelum hint dijamin terisi
+  struct FAT32DirectorySlotHint *hint = fat32_directory_hint(directory_cluster);
+  uint32_t cluster_number = hint->position.cluster_number;
+  uint32_t cluster_index = hint->position.cluster_index;
+  uint8_t slot = hint->position.slot;
+  uint32_t last_cluster = cluster_number;
+  while (cluster_number != FAT32_FAT_END_OF_FILE && cluster_number != FAT32_FAT_EMPTY_ENTRY)
+  {
+    read_clusters(&fat32_driver_state.dir_table_buf, cluster_number, 1);
+    for (uint8_t i = slot; i < FAT32_DIRECTORY_ENTRY_COUNT; i++)
+    {
+      if (fat32_driver_state.dir_table_buf.table[i].user_attribute != UATTR_NOT_EMPTY)
       {
-        read_clusters(request.buf + clusters_read * CLUSTER_SIZE, current_cluster, 1);
-        current_cluster = fat32_driver_state.fat_table.cluster_map[current_cluster];
-        clusters_read++;
+        position->cluster_number = cluster_number;
+        position->cluster_index = cluster_index;
+        position->slot = i;
+        hint->position = *position;
+        return true;
       }
-      return 0;
     }
+    last_cluster = cluster_number;
+    cluster_number = fat32_get_cluster_map(cluster_number);
+    cluster_index++;
+    slot = 0;
   }
 
-  return 2;
+  // Directory penuh, cluster baru disambungkan ke chain directory
+  uint32_t new_cluster = fat32_allocate_chain(last_cluster, 1);
+  if (new_cluster == 0)
+    return false;
+  fat32_flush_fat();
+  fat32_extent_invalidate(directory_cluster);
+  memset(&fat32_driver_state.dir_table_buf, 0, CLUSTER_SIZE);
+  write_clusters(&fat32_driver_state.dir_table_buf, new_cluster, 1);
+
+  position->cluster_number = new_cluster;
+  position->cluster_index = cluster_index;
+  position->slot = 0;
+  hint->position = *position;
+  return true;
 }
 
-// Membaca directory dari the FAT32 file system
-int8_t read_directory(struct FAT32DriverRequest request)
+// Memundurkan hint jika slot yang dibebaskan berada sebelum hint
+static void fat32_release_slot(uint32_t directory_cluster, const struct FAT32DirectoryPosition *position)
 {
-  // Membaca direktori
-  struct FAT32DirectoryTable dir;
-  read_clusters(&dir, request.parent_cluster_number, 1);
+  struct FAT32DirectorySlotHint *hint = fat32_directory_hint(directory_cluster);
+  if (position->cluster_index < hint->position.cluster_index ||
+      (position->cluster_index == hint->position.cluster_index && position->slot < hint->position.slot))
+    hint->position = *position;
+}
 
-  // Mencari folder dalam direktori
-  for (uint8_t i = 0; i < CLUSTER_SIZE / sizeof(struct FAT32DirectoryEntry);
-       i++)
+// Membaca file dari FAT32 file system
+int8_t read(struct FAT32DriverRequest request)
+{
+  // Mengecek apakah parent cluster merupakan directory
+  if (!fat32_is_directory(request.parent_cluster_number))
   {
-    struct FAT32DirectoryEntry entry = dir.table[i];
-
-    // Memeriksa apakah entry memiliki nama yang sama dengan request
-    if (memcmp(entry.name, request.name, sizeof(entry.name)) == 0)
-    {
-      // Jika entry adalah file, kembalikan error
-      if (!(entry.attribute & ATTR_SUBDIRECTORY))
-      {
-        return 1; // Error: Bukan sebuah folder (file)
-      }
+    return 2;
+  }
 
-      // Error jika buffer size < filesize
-      if (request.buffer_size < entry.filesize)
-      {
-        return -1; // Error: Buffer tidak cukup besar
-      }
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry dir_entry;
+  if (!fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &dir_entry))
+  {
+    return 2;
+  }
 
-      // Membaca folder dan menyimpan ke buffer
-      uint32_t cluster_number = (entry.cluster_high << 16) | entry.cluster_low;
-      read_clusters(request.buf, cluster_number, 1);
+  // Mengecek apakah entry merupakan directory
+  if (dir_entry.attribute & ATTR_SUBDIRECTORY)
+  {
+    return 1;
+  }
 
-      return 0;
-    }
+  // Mengecek apakah kapasitas buffer size cukup untuk menyimpan file data
+  uint32_t cluster_count = fat32_cluster_count(dir_entry.filesize);
+  if ((request.buffer_size / CLUSTER_SIZE) < cluster_count)
+  {
+    return -1;
   }
 
-  return 2; // Error: folder tidak ditemukan
+  // Membaca file data clusters dari disk, satu transfer untuk setiap run cluster kontigu
+  uint32_t current_cluster = fat32_entry_cluster(&dir_entry);
+  uint8_t *target = (uint8_t *)request.buf;
+  while (cluster_count > 0 && current_cluster != FAT32_FAT_END_OF_FILE)
+  {
+    uint32_t run_length = fat32_chain_run_length(current_cluster, cluster_count);
+    read_clusters(target, current_cluster, run_length);
+    target += run_length * CLUSTER_SIZE;
+    cluster_count -= run_length;
+    current_cluster = fat32_get_cluster_map(current_cluster + run_length - 1);
+  }
+  return 0;
 }
 
-// DONE
-int8_t write(struct FAT32DriverRequest request)
+// Membaca satu cluster directory, cluster_index 0 adalah cluster pertama
+int8_t read_directory_cluster(struct FAT32DriverRequest request, uint32_t cluster_index)
 {
-  // Mengecek apakah  parent cluster number bukan end of file marker
-  if (fat32_driver_state.fat_table.cluster_map[request.parent_cluster_number] != FAT32_FAT_END_OF_FILE)
+  if (!fat32_is_directory(request.parent_cluster_number))
     return 2;
 
-  // Menginisaliasi struktur dari directory table
-  struct FAT32DirectoryTable dir_table;
-  memset(&dir_table, 0, CLUSTER_SIZE);
+  // Mencari folder dalam direktori, nama entry-0 berarti parent directory itu sendiri
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &entry))
+  {
+    fat32_read_directory_self(request.parent_cluster_number, &entry, NULL);
+    if (memcmp(entry.name, request.name, sizeof(entry.name)))
+      return 2; // Error: folder tidak ditemukan
+    entry.cluster_low = request.parent_cluster_number & 0xFFFF;
+    entry.cluster_high = (request.parent_cluster_number >> 16) & 0xFFFF;
+  }
 
-  // Membaca directory table dari disk
-  read_clusters(&dir_table, request.parent_cluster_number, 1);
+  // Jika entry adalah file, kembalikan error
+  if (!(entry.attribute & ATTR_SUBDIRECTORY))
+    return 1; // Error: Bukan sebuah folder (file)
 
-  uint8_t dirtable_empty_slot = 0;
+  // Error jika buffer size < ukuran satu directory table
+  if (request.buffer_size < sizeof(struct FAT32DirectoryTable))
+    return -1; // Error: Buffer tidak cukup besar
 
-  for (uint8_t i = 2; i < 64; i++)
+  // Mengikuti chain directory hingga cluster ke-cluster_index
+  uint32_t cluster_number = fat32_entry_cluster(&entry);
+  for (uint32_t i = 0; i < cluster_index; i++)
   {
-    struct FAT32DirectoryEntry dir_entry = dir_table.table[i];
+    cluster_number = fat32_get_cluster_map(cluster_number);
+    if (cluster_number == FAT32_FAT_END_OF_FILE || cluster_number == FAT32_FAT_EMPTY_ENTRY)
+      return 3; // Error: cluster_index melewati akhir directory
+  }
 
-    // Mencari slot kosong di directory table
-    if (dir_entry.user_attribute != UATTR_NOT_EMPTY && dirtable_empty_slot == 0)
-    {
-      dirtable_empty_slot = i;
-    }
+  // Membaca folder dan menyimpan ke buffer
+  read_clusters(request.buf, cluster_number, 1);
+  return 0;
+}
 
-    // Mengecek jika entry sesuai dengan nama dan ekstensi requested file
-    if (!memcmp(&dir_entry.name, &request.name, 8) && !memcmp(&dir_entry.ext, &request.ext, 3))
-      return 1; // Error: File sudah ada
-  }
+// Membaca directory dari the FAT32 file system
+int8_t read_directory(struct FAT32DriverRequest request)
+{
+  return read_directory_cluster(request, 0);
+}
 
-  if (dirtable_empty_slot == 0)
-    return -1; // Error: Directory table penuh
+// DONE
+int8_t write(struct FAT32DriverRequest request)
+{
+  // Mengecek apakah parent cluster merupakan directory
+  if (!fat32_is_directory(request.parent_cluster_number))
+    return 2;
+
+  // Mengecek jika entry sesuai dengan nama dan ekstensi requested file
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry existing;
+  if (fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &existing))
+    return 1; // Error: File sudah ada
 
-  uint8_t required = ceil(request.buffer_size / (float)CLUSTER_SIZE);
+  uint32_t required = fat32_cluster_count(request.buffer_size);
 
   bool isFolder = false;
   if (request.buffer_size == 0)
@@ -319,21 +991,14 @@ int8_t write(struct FAT32DriverRequest request)
     required += 1; // Untuk folder, dibutuhkan satu cluster
   }
 
-  uint32_t slot_buf[required];
-  uint8_t empty = 0;
-  uint32_t i = 0;
-
-  // Mencari slots kosong di cluster map untuk file data
-  while (empty < required && i < CLUSTER_MAP_SIZE)
-  {
-    if (fat32_driver_state.fat_table.cluster_map[i] == FAT32_FAT_EMPTY_ENTRY)
-    {
-      slot_buf[empty++] = i;
-    }
-    i++;
-  }
+  // Mencari slot kosong di directory, directory diperpanjang jika penuh
+  if (fat32_driver_state.free_cluster_count < required ||
+      !fat32_find_free_slot(request.parent_cluster_number, &position))
+    return -1; // Error: Empty clusters tidak cukup
 
-  if (empty < required)
+  // Mengambil cluster kosong dari free bitmap, run kontigu diutamakan
+  uint32_t first_cluster = fat32_allocate_chain(0, required);
+  if (first_cluster == 0)
     return -1; // Error: Empty clusters tidak cukup untuk file data
 
   // Jika folder, insialisasi directory tablenya
@@ -344,40 +1009,52 @@ int8_t write(struct FAT32DriverRequest request)
     init_directory_table(&child_dir, request.name, request.parent_cluster_number);
 
     struct FAT32DirectoryEntry *child = &child_dir.table[0];
-    child->cluster_low = slot_buf[0] & 0xFFFF;
-    child->cluster_high = (slot_buf[0] >> 16) & 0xFFFF;
+    child->cluster_low = first_cluster & 0xFFFF;
+    child->cluster_high = (first_cluster >> 16) & 0xFFFF;
 
     // Menulis directory table ke disk
-    write_clusters(&child_dir, slot_buf[0], 1);
-
-    // Menandai last cluster di folder sebagai EOF
-    fat32_driver_state.fat_table.cluster_map[slot_buf[0]] = FAT32_FAT_END_OF_FILE;
-    write_clusters(&(fat32_driver_state.fat_table), FAT_CLUSTER_NUMBER, 1);
+    write_clusters(&child_dir, first_cluster, 1);
+    // Cluster bisa saja bekas directory lain, hint dan dentry lama dibuang
+    fat32_driver_state.directory_hint[first_cluster % FAT32_DIRECTORY_HINT_COUNT].directory_cluster = 0;
+    fat32_dentry_purge_directory(first_cluster);
   }
   else // Jika file
   {
-    // Menulis file data clusters ke disk
-    for (uint8_t j = 0; j < required; j++)
+    // Menulis file data clusters ke disk, satu transfer untuk setiap run cluster kontigu
+    const uint8_t *source = (const uint8_t *)request.buf;
+    uint32_t remaining_size = request.buffer_size;
+    uint32_t cluster_number = first_cluster;
+    while (remaining_size > 0)
     {
-
-      uint32_t cluster_num = slot_buf[j];
-      uint32_t next_cluster = (j < required - 1) ? slot_buf[j + 1] : FAT32_FAT_END_OF_FILE;
-
-      fat32_driver_state.fat_table.cluster_map[cluster_num] = next_cluster;
-      write_clusters(&(fat32_driver_state.fat_table), FAT_CLUSTER_NUMBER, 1);
-
-      write_clusters(request.buf, cluster_num, 1);
-      request.buf += CLUSTER_SIZE;
+      uint32_t run_length = fat32_chain_run_length(cluster_number, fat32_cluster_count(remaining_size));
+      uint32_t full_count = remaining_size / CLUSTER_SIZE < run_length ? remaining_size / CLUSTER_SIZE : run_length;
+      if (full_count > 0)
+        write_clusters(source, cluster_number, full_count);
+      source += full_count * CLUSTER_SIZE;
+      remaining_size -= full_count * CLUSTER_SIZE;
+
+      // Cluster terakhir yang tidak penuh diisi 0 agar tidak membaca melewati buffer
+      if (full_count < run_length)
+      {
+        memset(&fat32_driver_state.cluster_buf, 0, CLUSTER_SIZE);
+        memcpy(&fat32_driver_state.cluster_buf, source, remaining_size);
+        write_clusters(&fat32_driver_state.cluster_buf, cluster_number + full_count, 1);
+        remaining_size = 0;
+      }
+      cluster_number = fat32_get_cluster_map(cluster_number + run_length - 1);
     }
   }
 
+  // Hanya block FAT yang berubah ditulis, satu kali untuk seluruh cluster yang dialokasikan
+  fat32_flush_fat();
+
   // Membuat sebuah entry untuk file atau folder di directory table
   struct FAT32DirectoryEntry entry = {
       .attribute = isFolder ? ATTR_SUBDIRECTORY : 0,
       .user_attribute = UATTR_NOT_EMPTY,
 
-      .cluster_low = slot_buf[0] & 0xFFFF,
-      .cluster_high = (slot_buf[0] >> 16) & 0xFFFF,
+      .cluster_low = first_cluster & 0xFFFF,
+      .cluster_high = (first_cluster >> 16) & 0xFFFF,
       .filesize = request.buffer_size};
 
   // Menyalin nama dan ekstensi file atau folder ke entry
@@ -386,48 +1063,1025 @@ int8_t write(struct FAT32DriverRequest request)
   for (uint8_t b = 0; b < 3; b++)
     entry.ext[b] = request.ext[b];
 
-  // Menambahkan entry ke directory table
-  dir_table.table[dirtable_empty_slot] = entry;
+  // Menambahkan entry ke cluster directory yang berisi slot kosong
+  read_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  fat32_driver_state.dir_table_buf.table[position.slot] = entry;
 
   // Menulis directory table yang telah diperbarui ke disk
-  write_clusters(&dir_table, request.parent_cluster_number, 1);
+  write_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  fat32_dentry_store(request.parent_cluster_number, entry.name, &position, &entry);
 
   return 0;
 }
 
+// Lokasi counter referensi cluster pada refcount table, false jika volume belum memiliki table
+static bool fat32_refcount_location(uint32_t cluster_number, uint32_t *logical_block_address, uint16_t *offset)
+{
+  uint32_t table_cluster = fat32_driver_state.geometry.refcount_cluster;
+  if (table_cluster == 0 || cluster_number >= fat32_driver_state.geometry.cluster_count)
+    return false;
+  table_cluster = fat32_extent_lookup(table_cluster, cluster_number / CLUSTER_SIZE);
+  *logical_block_address = cluster_to_lba(table_cluster) + (cluster_number % CLUSTER_SIZE) / BLOCK_SIZE;
+  *offset = cluster_number % BLOCK_SIZE;
+  return true;
+}
+
+// Jumlah referensi tambahan cluster, 0 berarti cluster hanya dimiliki satu file
+static uint8_t fat32_get_refcount(uint32_t cluster_number)
+{
+  uint32_t logical_block_address;
+  uint16_t offset;
+  if (!fat32_refcount_location(cluster_number, &logical_block_address, &offset))
+    return 0;
+  uint8_t block[BLOCK_SIZE];
+  block_cache_read_blocks(block, logical_block_address, 1);
+  return block[offset];
+}
+
+static void fat32_set_refcount(uint32_t cluster_number, uint8_t refcount)
+{
+  uint32_t logical_block_address;
+  uint16_t offset;
+  if (!fat32_refcount_location(cluster_number, &logical_block_address, &offset))
+    return;
+  uint8_t block[BLOCK_SIZE];
+  block_cache_read_blocks(block, logical_block_address, 1);
+  block[offset] = refcount;
+  block_cache_write_blocks(block, logical_block_address, 1);
+}
+
+// Membuat refcount table (1 byte per cluster) saat clone pertama, lokasinya disimpan di geometry boot sector
+static bool fat32_create_refcount_table(void)
+{
+  uint32_t table_cluster_count = (fat32_driver_state.geometry.cluster_count + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+  uint32_t table_cluster = fat32_allocate_chain(0, table_cluster_count);
+  if (table_cluster == 0)
+    return false;
+  fat32_flush_fat();
+
+  memset(&fat32_driver_state.cluster_buf, 0, CLUSTER_SIZE);
+  for (uint32_t cluster_number = table_cluster; cluster_number != FAT32_FAT_END_OF_FILE;
+       cluster_number = fat32_get_cluster_map(cluster_number))
+    write_clusters(&fat32_driver_state.cluster_buf, cluster_number, 1);
+
+  fat32_driver_state.geometry.refcount_cluster = table_cluster;
+  uint8_t boot_sector[BLOCK_SIZE];
+  block_cache_read_blocks(boot_sector, BOOT_SECTOR, 1);
+  memcpy(boot_sector + FAT32_GEOMETRY_OFFSET, &fat32_driver_state.geometry, sizeof(struct FAT32Geometry));
+  block_cache_write_blocks(boot_sector, BOOT_SECTOR, 1);
+  return true;
+}
+
+// Melepas chain milik satu file, cluster yang masih dipakai file lain hanya dikurangi referensinya
+static void fat32_release_chain(uint32_t cluster_number)
+{
+  while (cluster_number != 0 && cluster_number != FAT32_FAT_END_OF_FILE)
+  {
+    uint32_t next_cluster_number = fat32_get_cluster_map(cluster_number);
+    uint8_t refcount = fat32_get_refcount(cluster_number);
+    if (refcount > 0)
+      fat32_set_refcount(cluster_number, refcount - 1);
+    else
+      fat32_set_cluster_map(cluster_number, FAT32_FAT_EMPTY_ENTRY);
+    cluster_number = next_cluster_number;
+  }
+}
+
+// Copy-on-write: cluster ke-0 hingga last_index dijadikan milik file sendiri sebelum diubah.
+// Cluster bersama selalu membentuk suffix dari chain, cluster bersama yang dicakup disalin dan
+// disambungkan ke sisa chain bersama. False jika cluster kosong tidak cukup
+static bool fat32_unshare(uint32_t parent_cluster, const struct FAT32DirectoryPosition *position,
+                          struct FAT32DirectoryEntry *entry, uint32_t last_index)
+{
+  if (fat32_driver_state.geometry.refcount_cluster == 0)
+    return true;
+  uint32_t first_cluster = fat32_entry_cluster(entry);
+  uint32_t last_cluster = fat32_extent_lookup(first_cluster, last_index);
+  if (fat32_get_refcount(last_cluster) == 0)
+    return true;
+
+  // Mencari cluster bersama pertama
+  uint32_t previous = 0;
+  uint32_t shared_cluster = first_cluster;
+  uint32_t shared_index = 0;
+  while (fat32_get_refcount(shared_cluster) == 0)
+  {
+    previous = shared_cluster;
+    shared_cluster = fat32_get_cluster_map(shared_cluster);
+    shared_index++;
+  }
+
+  uint32_t successor = fat32_get_cluster_map(last_cluster);
+  uint32_t copy_cluster = fat32_allocate_chain(0, last_index - shared_index + 1);
+  if (copy_cluster == 0)
+    return false;
+
+  // Menyalin data cluster bersama, file lain tetap memakai cluster lama
+  uint32_t source = shared_cluster;
+  uint32_t target = copy_cluster;
+  while (true)
+  {
+    read_clusters(&fat32_driver_state.cluster_buf, source, 1);
+    write_clusters(&fat32_driver_state.cluster_buf, target, 1);
+    fat32_set_refcount(source, fat32_get_refcount(source) - 1);
+    if (source == last_cluster)
+      break;
+    source = fat32_get_cluster_map(source);
+    target = fat32_get_cluster_map(target);
+  }
+  fat32_set_cluster_map(target, successor);
+  fat32_extent_invalidate(first_cluster);
+
+  if (previous != 0)
+    fat32_set_cluster_map(previous, copy_cluster);
+  else
+  {
+    // Cluster pertama berubah, directory entry dan dentry diperbarui
+    entry->cluster_low = copy_cluster & 0xFFFF;
+    entry->cluster_high = (copy_cluster >> 16) & 0xFFFF;
+    read_clusters(&fat32_driver_state.dir_table_buf, position->cluster_number, 1);
+    fat32_driver_state.dir_table_buf.table[position->slot].cluster_low = entry->cluster_low;
+    fat32_driver_state.dir_table_buf.table[position->slot].cluster_high = entry->cluster_high;
+    write_clusters(&fat32_driver_state.dir_table_buf, position->cluster_number, 1);
+    fat32_dentry_store(parent_cluster, entry->name, position, entry);
+  }
+  fat32_flush_fat();
+
+  // Cursor descriptor yang membuka file ini menunjuk cluster lama
+  for (uint8_t i = 0; i < FAT32_OPEN_FILE_COUNT; i++)
+  {
+    struct FAT32OpenFile *file = &fat32_driver_state.open_file[i];
+    if (file->used && file->parent_cluster_number == parent_cluster &&
+        file->position.cluster_number == position->cluster_number && file->position.slot == position->slot)
+    {
+      file->entry.cluster_low = entry->cluster_low;
+      file->entry.cluster_high = entry->cluster_high;
+      file->cursor.cluster_number = 0;
+    }
+  }
+  return true;
+}
+
+// Menutup seluruh descriptor yang membuka entry, dipanggil saat entry dihapus
+static void fat32_close_entry(uint32_t parent_cluster, const struct FAT32DirectoryPosition *position)
+{
+  for (uint8_t i = 0; i < FAT32_OPEN_FILE_COUNT; i++)
+  {
+    struct FAT32OpenFile *file = &fat32_driver_state.open_file[i];
+    if (file->used && file->parent_cluster_number == parent_cluster &&
+        file->position.cluster_number == position->cluster_number && file->position.slot == position->slot)
+      file->used = false;
+  }
+}
+
 // Menghapus file dari FAT32 file system
 int8_t delete(struct FAT32DriverRequest request)
 {
   // Membaca direktori
-  read_clusters(&fat32_driver_state.dir_table_buf, request.parent_cluster_number, 1);
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_is_directory(request.parent_cluster_number) ||
+      !fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &entry))
+    return 1; // Error: file tidak ditemukan
+
+  // Menghapus file, seluruh cluster pada chain dibebaskan
+  uint32_t cluster_number = fat32_entry_cluster(&entry);
+  fat32_release_chain(cluster_number);
+  fat32_extent_invalidate(cluster_number);
+  fat32_close_entry(request.parent_cluster_number, &position);
+  if (entry.attribute & ATTR_SUBDIRECTORY)
+  {
+    fat32_driver_state.directory_hint[cluster_number % FAT32_DIRECTORY_HINT_COUNT].directory_cluster = 0;
+    fat32_dentry_purge_directory(cluster_number);
+  }
+
+  // Menghapus entry
+  read_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  memset(&fat32_driver_state.dir_table_buf.table[position.slot], 0, sizeof(struct FAT32DirectoryEntry));
+  write_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  fat32_release_slot(request.parent_cluster_number, &position);
+  fat32_dentry_store(request.parent_cluster_number, entry.name, NULL, NULL);
+
+  // Menyimpan block File Allocation Table yang berubah
+  fat32_flush_fat();
+
+  return 0;
+}
+
+// Mengalokasikan cluster untuk ukuran akhir file, filesize tidak berubah (keep size)
+int8_t preallocate(struct FAT32DriverRequest request)
+{
+  if (!fat32_is_directory(request.parent_cluster_number))
+    return 2;
+  if (request.buffer_size == 0)
+    return -1;
+
+  uint32_t required = fat32_cluster_count(request.buffer_size);
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry existing;
+  if (fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &existing))
+  {
+    if (existing.attribute & ATTR_SUBDIRECTORY)
+      return 1;
+
+    // File sudah ada, chain diperpanjang dengan cluster setelah cluster terakhir jika kosong.
+    // Cluster terakhir akan diubah sehingga chain bersama (clone) disalin lebih dulu
+    uint32_t cluster_count;
+    fat32_chain_last(fat32_entry_cluster(&existing), &cluster_count);
+    if (cluster_count >= required)
+      return 0;
+    if (!fat32_unshare(request.parent_cluster_number, &position, &existing, cluster_count - 1) ||
+        !fat32_extend_file(fat32_entry_cluster(&existing), required))
+      return -1;
+    fat32_flush_fat();
+    return 0;
+  }
+
+  // File baru dengan filesize 0 dan chain yang sudah dialokasikan
+  if (fat32_driver_state.free_cluster_count < required ||
+      !fat32_find_free_slot(request.parent_cluster_number, &position))
+    return -1;
+  uint32_t first_cluster = fat32_allocate_chain(0, required);
+  if (first_cluster == 0)
+    return -1;
+  fat32_flush_fat();
+
+  read_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  struct FAT32DirectoryEntry *entry = &fat32_driver_state.dir_table_buf.table[position.slot];
+  memset(entry, 0, sizeof(struct FAT32DirectoryEntry));
+  memcpy(entry->name, request.name, 8);
+  memcpy(entry->ext, request.ext, 3);
+  entry->user_attribute = UATTR_NOT_EMPTY;
+  entry->cluster_low = first_cluster & 0xFFFF;
+  entry->cluster_high = (first_cluster >> 16) & 0xFFFF;
+  write_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  fat32_dentry_store(request.parent_cluster_number, entry->name, &position, entry);
+  return 0;
+}
+
+// Mengisi hasil resolve_path() dengan directory itu sendiri (path kosong, "/", "." atau "..")
+static int8_t fat32_resolve_directory(uint32_t cluster_number, uint32_t parent_cluster, struct FAT32PathEntry *result)
+{
+  struct FAT32DirectoryEntry self;
+  uint32_t stored_parent;
+  fat32_read_directory_self(cluster_number, &self, &stored_parent);
+  if (parent_cluster == 0)
+    parent_cluster = cluster_number == ROOT_CLUSTER_NUMBER ? ROOT_CLUSTER_NUMBER : stored_parent;
+  if (parent_cluster == 0)
+    return 2;
+
+  memcpy(result->name, self.name, 8);
+  memcpy(result->ext, self.ext, 3);
+  result->attribute = ATTR_SUBDIRECTORY;
+  result->cluster_number = cluster_number;
+  result->parent_cluster_number = parent_cluster;
+  result->filesize = 0;
+  return 0;
+}
+
+// Menerjemahkan path menjadi entry dalam satu pemanggilan, setiap komponen dicari lewat dentry cache
+int8_t resolve_path(struct FAT32PathRequest request, struct FAT32PathEntry *result)
+{
+  const char *path = request.path;
+  uint32_t current = request.start_cluster_number;
+  if (*path == '/')
+    current = ROOT_CLUSTER_NUMBER;
+  if (!fat32_is_directory(current))
+    return 2;
 
-  for (uint8_t i = 0; i < CLUSTER_SIZE / sizeof(struct FAT32DirectoryEntry); i++)
+  // Directory yang telah dilewati, ".." tidak perlu membaca entry-1 jika masih ada di stack
+  uint32_t visited[FAT32_PATH_MAX_DEPTH];
+  uint8_t depth = 0;
+  bool file_reached = false;
+  bool entry_found = false;
+  static const char empty_ext[3] = {0};
+
+  // Path harus diakhiri '\0' dalam FAT32_PATH_MAX_LENGTH karakter
+  uint32_t length = 0;
+  while (path[length] != '\0')
+    if (++length > FAT32_PATH_MAX_LENGTH)
+      return -1;
+
+  while (*path != '\0')
   {
-    struct FAT32DirectoryEntry entry = fat32_driver_state.dir_table_buf.table[i];
+    if (*path == '/')
+    {
+      path++;
+      continue;
+    }
+
+    // Memisahkan satu komponen path
+    char name[8] = {0};
+    uint8_t name_length = 0;
+    while (path[name_length] != '/' && path[name_length] != '\0')
+    {
+      if (name_length == 8)
+        return -1; // Error: nama komponen lebih dari 8 karakter
+      name[name_length] = path[name_length];
+      name_length++;
+    }
+    path += name_length;
+
+    // Komponen setelah file tidak valid
+    if (file_reached)
+      return 1;
 
-    // Memeriksa apakah entry memiliki nama yang sama dengan request
-    if (memcmp(entry.name, request.name, sizeof(entry.name)) == 0 &&
-        memcmp(entry.ext, request.ext, sizeof(entry.ext)) == 0)
+    if (name_length == 1 && name[0] == '.')
     {
-      // Menghapus file
-      uint32_t cluster_number = (entry.cluster_high << 16) | entry.cluster_low;
-      while (cluster_number != FAT32_FAT_END_OF_FILE)
+      entry_found = false;
+      continue;
+    }
+    if (name_length == 2 && name[0] == '.' && name[1] == '.')
+    {
+      if (depth > 0)
+        current = visited[--depth];
+      else if (current != ROOT_CLUSTER_NUMBER)
       {
-        uint32_t next_cluster_number = fat32_driver_state.fat_table.cluster_map[cluster_number];
-        fat32_driver_state.fat_table.cluster_map[cluster_number] = 0;
-        cluster_number = next_cluster_number;
+        struct FAT32DirectoryEntry self;
+        uint32_t parent_cluster;
+        fat32_read_directory_self(current, &self, &parent_cluster);
+        if (parent_cluster == 0)
+          return 2;
+        current = parent_cluster;
       }
+      entry_found = false;
+      continue;
+    }
 
-      // Menghapus entry
-      memset(&fat32_driver_state.dir_table_buf.table[i], 0, sizeof(struct FAT32DirectoryEntry));
-      write_clusters(&fat32_driver_state.dir_table_buf, request.parent_cluster_number, 1);
+    struct FAT32DirectoryPosition position;
+    struct FAT32DirectoryEntry entry;
+    if (!fat32_find_entry(current, name, empty_ext, &position, &entry))
+      return 2;
 
-      // Menyimpan File Allocation Table
-      write_clusters(&fat32_driver_state.fat_table, FAT_CLUSTER_NUMBER, 1);
+    memcpy(result->name, entry.name, 8);
+    memcpy(result->ext, entry.ext, 3);
+    result->attribute = entry.attribute;
+    result->cluster_number = fat32_entry_cluster(&entry);
+    result->parent_cluster_number = current;
+    result->filesize = entry.filesize;
+    entry_found = true;
 
-      return 0;
+    if (entry.attribute & ATTR_SUBDIRECTORY)
+    {
+      if (depth == FAT32_PATH_MAX_DEPTH)
+      {
+        // Stack penuh, directory terlama dibuang dan ".." akan membaca entry-1
+        memmove(visited, visited + 1, sizeof(visited) - sizeof(visited[0]));
+        depth--;
+      }
+      visited[depth++] = current;
+      current = result->cluster_number;
+    }
+    else
+      file_reached = true;
+  }
+
+  int8_t status = 0;
+  if (!entry_found)
+    status = fat32_resolve_directory(current, depth > 0 ? visited[depth - 1] : 0, result);
+
+  // Directory yang di-resolve hampir selalu langsung dibaca (ls / lookup), isinya di-prefetch
+  if (status == 0 && (result->attribute & ATTR_SUBDIRECTORY))
+    fat32_prefetch_clusters(result->cluster_number, 0, FAT32_READAHEAD_DIRECTORY);
+  return status;
+}
+
+// Cluster ke-cluster_index pada file, cursor dipakai jika menunjuk cluster yang sama atau sebelumnya
+static uint32_t fat32_cursor_cluster(uint32_t first_cluster, const struct FAT32FileCursor *cursor, uint32_t cluster_index)
+{
+  if (cursor != NULL && cursor->cluster_number != 0)
+  {
+    if (cursor->cluster_index == cluster_index)
+      return cursor->cluster_number;
+    if (cursor->cluster_index + 1 == cluster_index)
+      return fat32_get_cluster_map(cursor->cluster_number);
+  }
+  return fat32_extent_lookup(first_cluster, cluster_index);
+}
+
+// Membaca size byte data file mulai dari offset, return byte yang dibaca.
+// Cursor (boleh NULL) diperbarui ke cluster yang berisi byte terakhir
+static uint32_t fat32_read_entry(const struct FAT32DirectoryEntry *entry, uint32_t offset, void *buf, uint32_t size,
+                                 struct FAT32FileCursor *cursor)
+{
+  // Offset di akhir file atau setelahnya berarti EOF, tidak ada data yang dibaca
+  if (offset >= entry->filesize)
+    return 0;
+  uint32_t remaining = entry->filesize - offset;
+  if (size < remaining)
+    remaining = size;
+  uint32_t transferred_size = remaining;
+
+  uint8_t *target = (uint8_t *)buf;
+  uint32_t cluster_index = offset / CLUSTER_SIZE;
+  uint32_t cluster_offset = offset % CLUSTER_SIZE;
+  fat32_readahead(fat32_entry_cluster(entry), cluster_index, (offset + remaining - 1) / CLUSTER_SIZE - cluster_index + 1);
+  uint32_t cluster_number = fat32_cursor_cluster(fat32_entry_cluster(entry), cursor, cluster_index);
+  uint32_t last_cluster = cluster_number;
+  uint32_t last_index = cluster_index;
+  while (remaining > 0)
+  {
+    if (cluster_offset == 0 && remaining >= CLUSTER_SIZE)
+    {
+      // Cluster penuh dibaca langsung ke buffer, satu transfer untuk setiap run kontigu
+      uint32_t run_length = fat32_chain_run_length(cluster_number, remaining / CLUSTER_SIZE);
+      read_clusters(target, cluster_number, run_length);
+      target += run_length * CLUSTER_SIZE;
+      remaining -= run_length * CLUSTER_SIZE;
+      last_cluster = cluster_number + run_length - 1;
+      last_index = cluster_index + run_length - 1;
+      cluster_index += run_length;
+      cluster_number = fat32_get_cluster_map(last_cluster);
+    }
+    else
+    {
+      // Cluster awal / akhir yang tidak penuh dibaca lewat cluster_buf
+      uint32_t size = CLUSTER_SIZE - cluster_offset < remaining ? CLUSTER_SIZE - cluster_offset : remaining;
+      read_clusters(&fat32_driver_state.cluster_buf, cluster_number, 1);
+      memcpy(target, fat32_driver_state.cluster_buf.buf + cluster_offset, size);
+      target += size;
+      remaining -= size;
+      cluster_offset = 0;
+      last_cluster = cluster_number;
+      last_index = cluster_index;
+      cluster_index++;
+      cluster_number = fat32_get_cluster_map(cluster_number);
+    }
+  }
+  if (cursor != NULL)
+  {
+    cursor->cluster_index = last_index;
+    cursor->cluster_number = last_cluster;
+  }
+  return transferred_size;
+}
+
+// Menulis size byte ke file mulai dari offset (offset <= filesize), file diperpanjang jika perlu.
+// Entry, dentry dan descriptor yang membuka file yang sama diperbarui jika filesize bertambah
+static int8_t fat32_write_entry(uint32_t parent_cluster, const struct FAT32DirectoryPosition *position,
+                                struct FAT32DirectoryEntry *entry, uint32_t offset, const void *buf, uint32_t size,
+                                struct FAT32FileCursor *cursor)
+{
+  if (size == 0)
+    return 0;
+
+  // Cluster tambahan disambungkan setelah cluster terakhir, chain hasil preallocate dipakai lebih dulu
+  uint32_t end = offset + size;
+  if (end < offset)
+    return -1;
+
+  // Cluster bersama hasil clone yang akan diubah (termasuk cluster terakhir jika diperpanjang) disalin lebih dulu
+  uint32_t cluster_count;
+  fat32_chain_last(fat32_entry_cluster(entry), &cluster_count);
+  uint32_t modified_index = (end - 1) / CLUSTER_SIZE;
+  if (modified_index >= cluster_count)
+    modified_index = cluster_count - 1;
+  if (!fat32_unshare(parent_cluster, position, entry, modified_index))
+    return -1;
+
+  uint32_t first_cluster = fat32_entry_cluster(entry);
+  if (!fat32_extend_file(first_cluster, fat32_cluster_count(end)))
+    return -1;
+
+  const uint8_t *source = (const uint8_t *)buf;
+  uint32_t remaining = size;
+  uint32_t cluster_index = offset / CLUSTER_SIZE;
+  uint32_t cluster_offset = offset % CLUSTER_SIZE;
+  uint32_t cluster_number = fat32_cursor_cluster(first_cluster, cursor, cluster_index);
+  uint32_t last_cluster = cluster_number;
+  uint32_t last_index = cluster_index;
+  while (remaining > 0)
+  {
+    if (cluster_offset == 0 && remaining >= CLUSTER_SIZE)
+    {
+      uint32_t run_length = fat32_chain_run_length(cluster_number, remaining / CLUSTER_SIZE);
+      write_clusters(source, cluster_number, run_length);
+      source += run_length * CLUSTER_SIZE;
+      remaining -= run_length * CLUSTER_SIZE;
+      last_cluster = cluster_number + run_length - 1;
+      last_index = cluster_index + run_length - 1;
+      cluster_index += run_length;
+      cluster_number = fat32_get_cluster_map(last_cluster);
+    }
+    else
+    {
+      // Read-modify-write, cluster yang belum berisi data file diisi 0
+      uint32_t size = CLUSTER_SIZE - cluster_offset < remaining ? CLUSTER_SIZE - cluster_offset : remaining;
+      if (cluster_index * CLUSTER_SIZE < entry->filesize)
+        read_clusters(&fat32_driver_state.cluster_buf, cluster_number, 1);
+      else
+        memset(&fat32_driver_state.cluster_buf, 0, CLUSTER_SIZE);
+      memcpy(fat32_driver_state.cluster_buf.buf + cluster_offset, source, size);
+      write_clusters(&fat32_driver_state.cluster_buf, cluster_number, 1);
+      source += size;
+      remaining -= size;
+      cluster_offset = 0;
+      last_cluster = cluster_number;
+      last_index = cluster_index;
+      cluster_index++;
+      cluster_number = fat32_get_cluster_map(cluster_number);
+    }
+  }
+  if (cursor != NULL)
+  {
+    cursor->cluster_index = last_index;
+    cursor->cluster_number = last_cluster;
+  }
+  fat32_flush_fat();
+
+  // Filesize hanya diperbarui jika file bertambah panjang
+  if (end > entry->filesize)
+  {
+    read_clusters(&fat32_driver_state.dir_table_buf, position->cluster_number, 1);
+    fat32_driver_state.dir_table_buf.table[position->slot].filesize = end;
+    write_clusters(&fat32_driver_state.dir_table_buf, position->cluster_number, 1);
+    entry->filesize = end;
+    fat32_dentry_store(parent_cluster, entry->name, position, entry);
+    for (uint8_t i = 0; i < FAT32_OPEN_FILE_COUNT; i++)
+    {
+      struct FAT32OpenFile *file = &fat32_driver_state.open_file[i];
+      if (file->used && file->parent_cluster_number == parent_cluster &&
+          file->position.cluster_number == position->cluster_number && file->position.slot == position->slot)
+        file->entry.filesize = end;
+    }
+  }
+  return 0;
+}
+
+// Membaca sebagian file mulai dari offset, hanya cluster yang mencakup range yang dibaca
+int8_t read_range(struct FAT32RangeRequest *range)
+{
+  struct FAT32DriverRequest request = range->request;
+  range->transferred_size = 0;
+  if (!fat32_is_directory(request.parent_cluster_number))
+    return 2;
+
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &entry))
+    return 2;
+  if (entry.attribute & ATTR_SUBDIRECTORY)
+    return 1;
+
+  range->transferred_size = fat32_read_entry(&entry, range->offset, request.buf, request.buffer_size, NULL);
+  return 0;
+}
+
+// Menulis sebagian file mulai dari offset, file diperpanjang jika range melewati akhir file
+int8_t write_range(struct FAT32RangeRequest *range)
+{
+  struct FAT32DriverRequest request = range->request;
+  range->transferred_size = 0;
+  if (!fat32_is_directory(request.parent_cluster_number))
+    return 2;
+
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &entry))
+    return 2;
+  if (entry.attribute & ATTR_SUBDIRECTORY)
+    return 1;
+  if (range->offset > entry.filesize)
+    return 3;
+
+  int8_t status = fat32_write_entry(request.parent_cluster_number, &position, &entry, range->offset,
+                                    request.buf, request.buffer_size, NULL);
+  if (status == 0)
+    range->transferred_size = request.buffer_size;
+  return status;
+}
+
+// Descriptor yang sedang terbuka, NULL jika descriptor tidak valid
+static struct FAT32OpenFile *fat32_open_file(uint8_t descriptor)
+{
+  if (descriptor >= FAT32_OPEN_FILE_COUNT || !fat32_driver_state.open_file[descriptor].used)
+    return NULL;
+  return &fat32_driver_state.open_file[descriptor];
+}
+
+// Membuka file, directory entry dan lokasinya disimpan sehingga operasi berikutnya tidak mencari nama lagi
+int8_t open_file(struct FAT32DriverRequest request, uint8_t *descriptor)
+{
+  if (!fat32_is_directory(request.parent_cluster_number))
+    return 2;
+
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_find_entry(request.parent_cluster_number, request.name, request.ext, &position, &entry))
+    return 2;
+  if (entry.attribute & ATTR_SUBDIRECTORY)
+    return 1;
+
+  for (uint8_t i = 0; i < FAT32_OPEN_FILE_COUNT; i++)
+  {
+    struct FAT32OpenFile *file = &fat32_driver_state.open_file[i];
+    if (file->used)
+      continue;
+    memset(file, 0, sizeof(struct FAT32OpenFile));
+    file->used = true;
+    file->parent_cluster_number = request.parent_cluster_number;
+    file->position = position;
+    file->entry = entry;
+    *descriptor = i;
+    return 0;
+  }
+  return -1; // Error: open-file table penuh
+}
+
+// Menutup descriptor
+int8_t close_file(uint8_t descriptor)
+{
+  struct FAT32OpenFile *file = fat32_open_file(descriptor);
+  if (file == NULL)
+    return 2;
+  file->used = false;
+  return 0;
+}
+
+// Membaca dari posisi cursor descriptor, cursor maju sebanyak byte yang dibaca
+int8_t read_file(struct FAT32FileRequest *request)
+{
+  request->transferred_size = 0;
+  struct FAT32OpenFile *file = fat32_open_file(request->descriptor);
+  if (file == NULL)
+    return 2;
+
+  request->transferred_size = fat32_read_entry(&file->entry, file->offset, request->buf, request->size, &file->cursor);
+  file->offset += request->transferred_size;
+  return 0;
+}
+
+// Menulis pada posisi cursor descriptor, cursor maju sebanyak byte yang ditulis
+int8_t write_file(struct FAT32FileRequest *request)
+{
+  request->transferred_size = 0;
+  struct FAT32OpenFile *file = fat32_open_file(request->descriptor);
+  if (file == NULL)
+    return 2;
+
+  int8_t status = fat32_write_entry(file->parent_cluster_number, &file->position, &file->entry, file->offset,
+                                    request->buf, request->size, &file->cursor);
+  if (status != 0)
+    return status;
+  request->transferred_size = request->size;
+  file->offset += request->size;
+  return 0;
+}
+
+// Memindahkan cursor descriptor, posisi baru tidak boleh melewati akhir file
+int8_t seek_file(struct FAT32SeekRequest *request)
+{
+  struct FAT32OpenFile *file = fat32_open_file(request->descriptor);
+  if (file == NULL)
+    return 2;
+
+  int64_t base = 0;
+  if (request->whence == FAT32_SEEK_CURRENT)
+    base = file->offset;
+  else if (request->whence == FAT32_SEEK_END)
+    base = file->entry.filesize;
+  else if (request->whence != FAT32_SEEK_SET)
+    return -1;
+
+  int64_t offset = base + request->offset;
+  if (offset < 0 || offset > file->entry.filesize)
+    return 3;
+  file->offset = (uint32_t)offset;
+  request->position = file->offset;
+  return 0;
+}
+
+// True jika directory ancestor berada di jalur ".." dari directory_cluster menuju root
+static bool fat32_is_ancestor(uint32_t ancestor, uint32_t directory_cluster)
+{
+  for (uint32_t depth = 0; depth < FAT32_MAX_CLUSTER_COUNT; depth++)
+  {
+    if (directory_cluster == ancestor)
+      return true;
+    if (directory_cluster == ROOT_CLUSTER_NUMBER)
+      return false;
+    struct FAT32DirectoryEntry self;
+    uint32_t parent_cluster;
+    fat32_read_directory_self(directory_cluster, &self, &parent_cluster);
+    // Directory versi lama tanpa entry-1, jalur ke root tidak diketahui
+    if (parent_cluster == 0)
+      return false;
+    directory_cluster = parent_cluster;
+  }
+  return false;
+}
+
+// Memindahkan / mengganti nama entry, hanya directory entry yang ditulis ulang tanpa menyalin data
+int8_t rename_entry(struct FAT32DriverRequest source, struct FAT32DriverRequest destination)
+{
+  struct FAT32DirectoryPosition source_position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_is_directory(source.parent_cluster_number) ||
+      !fat32_find_entry(source.parent_cluster_number, source.name, source.ext, &source_position, &entry))
+    return 1;
+  if (!fat32_is_directory(destination.parent_cluster_number))
+    return 2;
+
+  struct FAT32DirectoryPosition destination_position;
+  struct FAT32DirectoryEntry existing;
+  if (fat32_find_entry(destination.parent_cluster_number, destination.name, destination.ext, &destination_position, &existing))
+    return 3;
+
+  // Folder tidak boleh dipindahkan ke dalam dirinya sendiri atau subdirectory-nya
+  uint32_t cluster_number = fat32_entry_cluster(&entry);
+  bool is_folder = entry.attribute & ATTR_SUBDIRECTORY;
+  if (is_folder && fat32_is_ancestor(cluster_number, destination.parent_cluster_number))
+    return 4;
+
+  char old_key[FAT32_DENTRY_NAME_SIZE];
+  memcpy(old_key, entry.name, FAT32_DENTRY_NAME_SIZE);
+  memcpy(entry.name, destination.name, 8);
+  memcpy(entry.ext, destination.ext, 3);
+
+  if (source.parent_cluster_number == destination.parent_cluster_number)
+  {
+    // Directory yang sama, cukup mengganti nama pada slot lama
+    destination_position = source_position;
+    read_clusters(&fat32_driver_state.dir_table_buf, source_position.cluster_number, 1);
+    fat32_driver_state.dir_table_buf.table[source_position.slot] = entry;
+    write_clusters(&fat32_driver_state.dir_table_buf, source_position.cluster_number, 1);
+  }
+  else
+  {
+    // Entry ditulis ke directory tujuan lebih dulu agar tidak hilang jika slot tujuan tidak tersedia
+    if (!fat32_find_free_slot(destination.parent_cluster_number, &destination_position))
+      return -1;
+    fat32_driver_state.dir_table_buf.table[destination_position.slot] = entry;
+    write_clusters(&fat32_driver_state.dir_table_buf, destination_position.cluster_number, 1);
+
+    read_clusters(&fat32_driver_state.dir_table_buf, source_position.cluster_number, 1);
+    memset(&fat32_driver_state.dir_table_buf.table[source_position.slot], 0, sizeof(struct FAT32DirectoryEntry));
+    write_clusters(&fat32_driver_state.dir_table_buf, source_position.cluster_number, 1);
+    fat32_release_slot(source.parent_cluster_number, &source_position);
+  }
+
+  // Folder yang dipindahkan: nama entry-0 dan ".." pada entry-1 diperbarui
+  if (is_folder)
+  {
+    read_clusters(&fat32_driver_state.dir_table_buf, cluster_number, 1);
+    struct FAT32DirectoryTable *folder = &fat32_driver_state.dir_table_buf;
+    memcpy(folder->table[0].name, destination.name, 8);
+    if (folder->table[1].attribute & ATTR_SUBDIRECTORY)
+    {
+      folder->table[1].cluster_low = destination.parent_cluster_number & 0xFFFF;
+      folder->table[1].cluster_high = (destination.parent_cluster_number >> 16) & 0xFFFF;
+    }
+    write_clusters(folder, cluster_number, 1);
+  }
+
+  fat32_dentry_store(source.parent_cluster_number, old_key, NULL, NULL);
+  fat32_dentry_store(destination.parent_cluster_number, entry.name, &destination_position, &entry);
+
+  // Descriptor yang membuka entry mengikuti lokasi barunya
+  for (uint8_t i = 0; i < FAT32_OPEN_FILE_COUNT; i++)
+  {
+    struct FAT32OpenFile *file = &fat32_driver_state.open_file[i];
+    if (file->used && file->parent_cluster_number == source.parent_cluster_number &&
+        file->position.cluster_number == source_position.cluster_number && file->position.slot == source_position.slot)
+    {
+      file->parent_cluster_number = destination.parent_cluster_number;
+      file->position = destination_position;
+      memcpy(file->entry.name, entry.name, FAT32_DENTRY_NAME_SIZE);
+    }
+  }
+  return 0;
+}
+
+// Clone (reflink) file, entry baru memakai chain yang sama dan referensi setiap cluster ditambah
+int8_t clone_entry(struct FAT32DriverRequest source, struct FAT32DriverRequest destination)
+{
+  struct FAT32DirectoryPosition position;
+  struct FAT32DirectoryEntry entry;
+  if (!fat32_is_directory(source.parent_cluster_number) ||
+      !fat32_find_entry(source.parent_cluster_number, source.name, source.ext, &position, &entry))
+    return 1;
+  if (entry.attribute & ATTR_SUBDIRECTORY)
+    return 1;
+  if (!fat32_is_directory(destination.parent_cluster_number))
+    return 2;
+  struct FAT32DirectoryEntry existing;
+  if (fat32_find_entry(destination.parent_cluster_number, destination.name, destination.ext, &position, &existing))
+    return 3;
+
+  if (fat32_driver_state.geometry.refcount_cluster == 0 && !fat32_create_refcount_table())
+    return -1;
+  if (!fat32_find_free_slot(destination.parent_cluster_number, &position))
+    return -1;
+
+  // Counter tidak boleh overflow, diperiksa sebelum ada yang diubah
+  uint32_t first_cluster = fat32_entry_cluster(&entry);
+  for (uint32_t cluster_number = first_cluster; cluster_number != FAT32_FAT_END_OF_FILE;
+       cluster_number = fat32_get_cluster_map(cluster_number))
+    if (fat32_get_refcount(cluster_number) == FAT32_REFCOUNT_MAX)
+      return -1;
+  for (uint32_t cluster_number = first_cluster; cluster_number != FAT32_FAT_END_OF_FILE;
+       cluster_number = fat32_get_cluster_map(cluster_number))
+    fat32_set_refcount(cluster_number, fat32_get_refcount(cluster_number) + 1);
+
+  memcpy(entry.name, destination.name, 8);
+  memcpy(entry.ext, destination.ext, 3);
+  read_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  fat32_driver_state.dir_table_buf.table[position.slot] = entry;
+  write_clusters(&fat32_driver_state.dir_table_buf, position.cluster_number, 1);
+  fat32_dentry_store(destination.parent_cluster_number, entry.name, &position, &entry);
+  return 0;
+}
+
+// Menyalin entry yang terisi ke buffer caller sebagai record ringkas, dilanjutkan dari cookie
+int8_t list_directory(struct FAT32ListRequest *request)
+{
+  request->record_count = 0;
+  if (!fat32_is_directory(request->directory_cluster))
+    return 2;
+  if (request->prefix_length > 8)
+    return -1;
+  if (request->cookie == FAT32_LIST_COOKIE_END)
+    return 0;
+
+  uint32_t cluster_index = request->cookie / FAT32_DIRECTORY_ENTRY_COUNT;
+  uint32_t slot = request->cookie % FAT32_DIRECTORY_ENTRY_COUNT;
+  uint32_t cluster_number = fat32_extent_lookup(request->directory_cluster, cluster_index);
+  while (cluster_number != FAT32_FAT_END_OF_FILE && cluster_number != FAT32_FAT_EMPTY_ENTRY)
+  {
+    read_clusters(&fat32_driver_state.dir_table_buf, cluster_number, 1);
+    if (slot < fat32_directory_first_slot(cluster_index))
+      slot = fat32_directory_first_slot(cluster_index);
+    for (; slot < FAT32_DIRECTORY_ENTRY_COUNT; slot++)
+    {
+      struct FAT32DirectoryEntry *entry = &fat32_driver_state.dir_table_buf.table[slot];
+      if (entry->user_attribute != UATTR_NOT_EMPTY || memcmp(entry->name, request->prefix, request->prefix_length))
+        continue;
+
+      // Buffer penuh, listing dilanjutkan dari entry ini pada pemanggilan berikutnya
+      if (request->record_count == request->record_capacity)
+      {
+        request->cookie = cluster_index * FAT32_DIRECTORY_ENTRY_COUNT + slot;
+        return 0;
+      }
+      struct FAT32DirectoryRecord *record = &request->buf[request->record_count++];
+      memcpy(record->name, entry->name, 8);
+      memcpy(record->ext, entry->ext, 3);
+      record->attribute = entry->attribute;
+      record->cluster_number = fat32_entry_cluster(entry);
+      record->filesize = entry->filesize;
+    }
+    cluster_number = fat32_get_cluster_map(cluster_number);
+    cluster_index++;
+    slot = 0;
+  }
+  request->cookie = FAT32_LIST_COOKIE_END;
+  return 0;
+}
+
+// Pencocokan wildcard, '*' diulang dari posisi terakhir jika sisa pattern gagal
+static bool fat32_glob_match(const char *pattern, const char *text)
+{
+  const char *star = NULL;
+  const char *resume = NULL;
+  while (*text != '\0')
+  {
+    if (*pattern == '*')
+    {
+      star = pattern++;
+      resume = text;
+    }
+    else if (*pattern == '?' || *pattern == *text)
+    {
+      pattern++;
+      text++;
+    }
+    else if (star != NULL)
+    {
+      pattern = star + 1;
+      text = ++resume;
     }
+    else
+      return false;
+  }
+  while (*pattern == '*')
+    pattern++;
+  return *pattern == '\0';
+}
+
+// Nama entry dalam bentuk "name.ext" (ext dihilangkan jika kosong), mengembalikan panjang
+static uint8_t fat32_entry_display_name(const struct FAT32DirectoryEntry *entry, char *out)
+{
+  uint8_t length = 0;
+  for (uint8_t i = 0; i < 8 && entry->name[i] != '\0'; i++)
+    out[length++] = entry->name[i];
+  if (entry->ext[0] != '\0')
+  {
+    out[length++] = '.';
+    for (uint8_t i = 0; i < 3 && entry->ext[i] != '\0'; i++)
+      out[length++] = entry->ext[i];
+  }
+  out[length] = '\0';
+  return length;
+}
+
+// Menelusuri subtree secara depth-first, state disimpan di request agar bisa dilanjutkan
+int8_t find_entries(struct FAT32FindRequest *request)
+{
+  request->match_count = 0;
+  request->used_size = 0;
+  if (request->done)
+    return 0;
+  if (request->depth > FAT32_PATH_MAX_DEPTH)
+    return -1;
+  uint8_t pattern_length = 0;
+  while (request->pattern[pattern_length] != '\0')
+    if (++pattern_length == FAT32_FIND_PATTERN_LENGTH)
+      return -1; // Error: pattern tidak diakhiri '\0'
+
+  // Pemanggilan pertama, root menjadi dasar stack
+  if (request->depth == 0)
+  {
+    if (!fat32_is_directory(request->root_cluster))
+      return 2;
+    request->depth = 1;
+    request->cluster[0] = request->root_cluster;
+    request->cookie[0] = 0;
+    request->path_length[0] = 0;
   }
 
-  return 1; // Error: file tidak ditemukan
-}
\ No newline at end of file
+  // Cluster yang sedang ada di dir_table_buf, kembali dari subdirectory akan dilayani block cache
+  uint32_t loaded_cluster = 0;
+  while (request->depth > 0)
+  {
+    uint8_t level = request->depth - 1;
+    uint32_t directory_cluster = request->cluster[level];
+    uint16_t path_length = request->path_length[level];
+    if (path_length >= FAT32_PATH_MAX_LENGTH)
+      return -1;
+
+    uint32_t cluster_index = request->cookie[level] / FAT32_DIRECTORY_ENTRY_COUNT;
+    uint32_t slot = request->cookie[level] % FAT32_DIRECTORY_ENTRY_COUNT;
+    uint32_t cluster_number = fat32_extent_lookup(directory_cluster, cluster_index);
+    bool descended = false;
+    while (!descended && cluster_number != FAT32_FAT_END_OF_FILE && cluster_number != FAT32_FAT_EMPTY_ENTRY)
+    {
+      if (cluster_number != loaded_cluster)
+      {
+        read_clusters(&fat32_driver_state.dir_table_buf, cluster_number, 1);
+        loaded_cluster = cluster_number;
+      }
+      if (slot < fat32_directory_first_slot(cluster_index))
+        slot = fat32_directory_first_slot(cluster_index);
+
+      for (; slot < FAT32_DIRECTORY_ENTRY_COUNT; slot++)
+      {
+        struct FAT32DirectoryEntry *entry = &fat32_driver_state.dir_table_buf.table[slot];
+        if (entry->user_attribute != UATTR_NOT_EMPTY)
+          continue;
+
+        char name[FAT32_FIND_PATTERN_LENGTH];
+        uint8_t name_length = fat32_entry_display_name(entry, name);
+        uint32_t entry_path_length = path_length + 1 + name_length;
+        if (fat32_glob_match(request->pattern, name))
+        {
+          // Buffer penuh, entry ini diproses ulang pada pemanggilan berikutnya
+          if (request->used_size + entry_path_length + 1 > request->buffer_size)
+          {
+            request->cookie[level] = cluster_index * FAT32_DIRECTORY_ENTRY_COUNT + slot;
+            return request->match_count == 0 ? -1 : 0;
+          }
+          char *out = request->buf + request->used_size;
+          memcpy(out, request->path, path_length);
+          out[path_length] = '/';
+          memcpy(out + path_length + 1, name, name_length + 1);
+          request->used_size += entry_path_length + 1;
+          request->match_count++;
+        }
+
+        if ((entry->attribute & ATTR_SUBDIRECTORY) && request->depth < FAT32_PATH_MAX_DEPTH &&
+            entry_path_length < FAT32_PATH_MAX_LENGTH)
+        {
+          request->cookie[level] = cluster_index * FAT32_DIRECTORY_ENTRY_COUNT + slot + 1;
+          request->path[path_length] = '/';
+          memcpy(request->path + path_length + 1, name, name_length);
+          request->cluster[request->depth] = fat32_entry_cluster(entry);
+          request->cookie[request->depth] = 0;
+          request->path_length[request->depth] = entry_path_length;
+          request->depth++;
+          descended = true;
+          break;
+        }
+      }
+      if (!descended)
+      {
+        cluster_number = fat32_get_cluster_map(cluster_number);
+        cluster_index++;
+        slot = 0;
+      }
+    }
+    if (!descended)
+      request->depth--;
+  }
+  request->done = true;
+  return 0;
+}
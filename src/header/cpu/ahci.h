@@ -0,0 +1,216 @@
+#ifndef _AHCI_H
+#define _AHCI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "disk.h"
+
+// ABAR, AHCI base memory register is BAR5
+#define AHCI_ABAR_INDEX 5
+
+/* -- HBA generic host control registers (offset from ABAR) -- */
+#define AHCI_HBA_CAP 0x00
+#define AHCI_HBA_GHC 0x04
+#define AHCI_HBA_IS 0x08
+#define AHCI_HBA_PI 0x0C
+#define AHCI_HBA_PORT_BASE 0x100
+#define AHCI_HBA_PORT_SIZE 0x80
+#define AHCI_HBA_PORT_COUNT 32
+
+#define AHCI_CAP_SNCQ (1u << 30)
+#define AHCI_CAP_NCS_SHIFT 8
+#define AHCI_CAP_NCS_MASK 0x1F
+#define AHCI_GHC_IE (1u << 1)
+#define AHCI_GHC_AE (1u << 31)
+
+/* -- Port registers (offset from port base) -- */
+#define AHCI_PORT_CLB 0x00
+#define AHCI_PORT_CLBU 0x04
+#define AHCI_PORT_FB 0x08
+#define AHCI_PORT_FBU 0x0C
+#define AHCI_PORT_IS 0x10
+#define AHCI_PORT_IE 0x14
+#define AHCI_PORT_CMD 0x18
+#define AHCI_PORT_TFD 0x20
+#define AHCI_PORT_SIG 0x24
+#define AHCI_PORT_SSTS 0x28
+#define AHCI_PORT_SERR 0x30
+#define AHCI_PORT_SACT 0x34
+#define AHCI_PORT_CI 0x38
+
+#define AHCI_PORT_CMD_ST (1 << 0)
+#define AHCI_PORT_CMD_FRE (1 << 4)
+#define AHCI_PORT_CMD_FR (1 << 14)
+#define AHCI_PORT_CMD_CR (1 << 15)
+
+#define AHCI_PORT_IS_DHRS (1u << 0) // Device to host register FIS, non-queued command completion
+#define AHCI_PORT_IS_PSS (1u << 1)  // PIO setup FIS
+#define AHCI_PORT_IS_SDBS (1u << 3) // Set device bits FIS, NCQ command completion
+#define AHCI_PORT_IS_TFES (1u << 30) // Task file error
+#define AHCI_PORT_IE_DEFAULT (AHCI_PORT_IS_DHRS | AHCI_PORT_IS_PSS | AHCI_PORT_IS_SDBS | AHCI_PORT_IS_TFES)
+
+#define AHCI_SSTS_DET_MASK 0xF
+#define AHCI_SSTS_DET_PRESENT 3
+// Port signature of ATA disk (not ATAPI, port multiplier, or enclosure)
+#define AHCI_SIG_ATA 0x00000101
+
+/* -- Command list & FIS -- */
+#define AHCI_FIS_TYPE_REG_H2D 0x27
+#define AHCI_FIS_COMMAND 0x80 // H2D register FIS C bit, FIS carry command instead of device control
+#define AHCI_COMMAND_FIS_DWORD_COUNT 5
+#define AHCI_COMMAND_HEADER_WRITE (1 << 6)
+#define AHCI_DEVICE_LBA 0x40
+#define AHCI_RECEIVED_FIS_SIZE 256
+#define AHCI_PRD_MAX_BYTE_COUNT (1 << 22)
+
+// Command slot count, each slot can be one outstanding NCQ command
+#define AHCI_SLOT_COUNT 32
+// PRD entry per command table, 64 * 16 byte + 128 byte header keep table 128-byte aligned
+#define AHCI_PRDT_ENTRY_COUNT 64
+// Bounce buffer, used when target memory cannot be translated into physical address or not 2-byte aligned
+#define AHCI_BOUNCE_BLOCK_COUNT 128
+
+/* -- ATA commands & IDENTIFY word used by AHCI -- */
+#define ATA_COMMAND_READ_FPDMA_QUEUED 0x60
+#define ATA_COMMAND_WRITE_FPDMA_QUEUED 0x61
+#define ATA_IDENTIFY_QUEUE_DEPTH 75
+#define ATA_IDENTIFY_SATA_CAPABILITY 76
+#define ATA_IDENTIFY_NCQ_SUPPORTED (1 << 8)
+
+/**
+ * AHCICommandHeader - Entry of port command list, one per command slot
+ *
+ * @param flag                        Command FIS length (dword), write bit, and other control bit
+ * @param prdt_length                 PRD entry count in command table
+ * @param prd_byte_count              Transferred byte count, updated by HBA
+ * @param command_table_address       Physical address of command table, 128-byte aligned
+ * @param command_table_address_upper Upper 32-bit of command table address, always 0
+ */
+struct AHCICommandHeader
+{
+    uint16_t flag;
+    uint16_t prdt_length;
+    volatile uint32_t prd_byte_count;
+    uint32_t command_table_address;
+    uint32_t command_table_address_upper;
+    uint32_t reserved[4];
+} __attribute__((packed));
+
+/**
+ * AHCIPhysicalRegionDescriptor - Entry of command table PRDT
+ *
+ * @param data_address       Physical address of data, 2-byte aligned
+ * @param data_address_upper Upper 32-bit of data address, always 0
+ * @param byte_count         Bit 21:0 region size in byte minus 1 (must be even size), bit 31 interrupt on completion
+ */
+struct AHCIPhysicalRegionDescriptor
+{
+    uint32_t data_address;
+    uint32_t data_address_upper;
+    uint32_t reserved;
+    uint32_t byte_count;
+} __attribute__((packed));
+
+/**
+ * AHCIRegisterFIS - Host to device register FIS, carry ATA command
+ *
+ * @param type         AHCI_FIS_TYPE_REG_H2D
+ * @param flag         AHCI_FIS_COMMAND
+ * @param command      ATA command
+ * @param feature_low  Feature 7:0, block count 7:0 for FPDMA QUEUED
+ * @param lba_low      LBA 23:0
+ * @param device       Device register, AHCI_DEVICE_LBA
+ * @param lba_high     LBA 47:24
+ * @param feature_high Feature 15:8, block count 15:8 for FPDMA QUEUED
+ * @param count        Block count, NCQ tag (bit 7:3) for FPDMA QUEUED
+ * @param control      Device control register
+ */
+struct AHCIRegisterFIS
+{
+    uint8_t type;
+    uint8_t flag;
+    uint8_t command;
+    uint8_t feature_low;
+    uint8_t lba_low[3];
+    uint8_t device;
+    uint8_t lba_high[3];
+    uint8_t feature_high;
+    uint16_t count;
+    uint8_t icc;
+    uint8_t control;
+    uint32_t reserved;
+} __attribute__((packed));
+
+/**
+ * AHCICommandTable - Command FIS and PRDT of one command slot, 128-byte aligned
+ *
+ * @param command_fis   Command FIS, struct AHCIRegisterFIS
+ * @param atapi_command ATAPI command, not used
+ * @param prdt          Physical region descriptor table
+ */
+struct AHCICommandTable
+{
+    uint8_t command_fis[64];
+    uint8_t atapi_command[16];
+    uint8_t reserved[48];
+    struct AHCIPhysicalRegionDescriptor prdt[AHCI_PRDT_ENTRY_COUNT];
+} __attribute__((packed));
+
+/**
+ * AHCICommand - Command issued on slot, kept for reissue after task file error
+ *
+ * @param logical_block_address First block
+ * @param block_count           Block count
+ * @param write                 True for write
+ */
+struct AHCICommand
+{
+    uint32_t logical_block_address;
+    uint32_t block_count;
+    bool write;
+} __attribute__((packed));
+
+/**
+ * AHCIPortState - State of AHCI port used as block backend
+ *
+ * @param hba          HBA register MMIO base (mapped ABAR)
+ * @param port         Port register MMIO base
+ * @param port_number  Port index, bit of HBA interrupt status
+ * @param slot_count   Usable command slot, minimum of HBA slot count and drive queue depth
+ * @param ncq          Issue read / write as FPDMA QUEUED, disabled after task file error
+ * @param issued       Slot issued and not yet reaped
+ * @param batch        Inside disk_batch_begin(), command is not waited
+ * @param irq          PIC IRQ from PCI interrupt line
+ * @param irq_enabled  Interrupt completion path is active
+ * @param error        Task file error, set by ISR or polling
+ * @param block_count  Addressable block count of drive
+ * @param command      Command of each slot
+ */
+struct AHCIPortState
+{
+    volatile uint8_t *hba;
+    volatile uint8_t *port;
+    uint8_t port_number;
+    uint8_t slot_count;
+    bool ncq;
+    uint32_t issued;
+    bool batch;
+    uint8_t irq;
+    bool irq_enabled;
+    volatile bool error;
+    uint32_t block_count;
+    struct AHCICommand command[AHCI_SLOT_COUNT];
+} __attribute__((packed));
+
+/**
+ * Find AHCI controller with PCI enumeration, start first port with attached ATA disk, and IDENTIFY it.
+ * Read / write is issued as NCQ (FPDMA QUEUED) command when HBA & drive support it, up to slot_count
+ * command can be outstanding inside disk_batch_begin().
+ *
+ * @param device Output, filled with AHCI operations when disk found
+ * @return       True if AHCI disk found and ready
+ */
+bool ahci_initialize(struct BlockDevice *device);
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef _BLOCK_CACHE_H
+#define _BLOCK_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "disk.h"
+
+/* -- Block cache constants -- */
+// Cache line granularity, 4 block = 1 FAT32 cluster, line always aligned to its size
+#define BLOCK_CACHE_LINE_BLOCK_COUNT 4
+#define BLOCK_CACHE_LINE_SIZE (BLOCK_SIZE * BLOCK_CACHE_LINE_BLOCK_COUNT)
+// Upper bound of line count, metadata is statically allocated (4 MiB of cached data)
+#define BLOCK_CACHE_MAX_LINE_COUNT 2048
+// Hash bucket count, must be power of two
+#define BLOCK_CACHE_HASH_BITS 10
+#define BLOCK_CACHE_HASH_SIZE (1 << BLOCK_CACHE_HASH_BITS)
+// Transfer larger than this will bypass the cache, preventing large sequential file from flushing metadata
+#define BLOCK_CACHE_BYPASS_BLOCK_COUNT (16 * BLOCK_CACHE_LINE_BLOCK_COUNT)
+// Null index for hash chain & LRU list
+#define BLOCK_CACHE_NONE 0xFFFF
+// Write-back: flush when dirty line count reach this value
+#define BLOCK_CACHE_DIRTY_THRESHOLD 256
+// Write-back: flush when oldest dirty line is older than this (timer tick, 3 second with 100 Hz PIT)
+#define BLOCK_CACHE_FLUSH_INTERVAL_TICKS 300
+// Max adjacent line transferred as single vectored command (dirty line flush, miss & prefetch read)
+#define BLOCK_CACHE_FLUSH_LINE_COUNT 32
+
+/**
+ * BlockCacheLine - Metadata of one cache line, data is located at storage + index * BLOCK_CACHE_LINE_SIZE
+ *
+ * @param line_number Cached line number, logical block address / BLOCK_CACHE_LINE_BLOCK_COUNT
+ * @param hash_next   Next line index in same hash bucket
+ * @param lru_prev    Previous (more recently used) line index
+ * @param lru_next    Next (less recently used) line index
+ * @param valid       True if line contain data of line_number
+ * @param dirty_mask  Write-back: bit i set if block i of this line is newer than disk
+ * @param readahead   Line is filled by block_cache_prefetch() and not yet read
+ */
+struct BlockCacheLine
+{
+    uint32_t line_number;
+    uint16_t hash_next;
+    uint16_t lru_prev;
+    uint16_t lru_next;
+    bool valid;
+    uint8_t dirty_mask;
+    bool readahead;
+} __attribute__((packed));
+
+/**
+ * BlockCacheStatistics - Counter for block cache lookup
+ *
+ * @param hit      Line lookup served from memory
+ * @param miss     Line lookup that require disk read
+ * @param eviction Valid line reused for another line_number
+ * @param bypass   Transfer that is too large and go directly to disk
+ * @param flush    Write-back flush (sync, threshold, or timer) count
+ * @param flush_write_command Write command issued for flushing dirty line, include dirty eviction
+ * @param readahead       Line read by block_cache_prefetch()
+ * @param readahead_hit   Prefetched line that is later read
+ * @param readahead_waste Prefetched line evicted before read
+ */
+struct BlockCacheStatistics
+{
+    uint32_t hit;
+    uint32_t miss;
+    uint32_t eviction;
+    uint32_t bypass;
+    uint32_t flush;
+    uint32_t flush_write_command;
+    uint32_t readahead;
+    uint32_t readahead_hit;
+    uint32_t readahead_waste;
+} __attribute__((packed));
+
+/**
+ * BlockCacheState - Contain all block cache states
+ *
+ * @param line       Line metadata, only first line_count is used
+ * @param hash       Hash bucket head, line index
+ * @param lru_head   Most recently used line index
+ * @param lru_tail   Least recently used line index, next victim
+ * @param line_count Line count, sized from storage given to block_cache_initialize()
+ * @param storage    Line data storage
+ * @param write_back          Write-back mode, write only update cache until flushed
+ * @param dirty_count         Line count with non-zero dirty_mask
+ * @param tick                Timer tick counter, incremented by block_cache_timer_tick()
+ * @param oldest_dirty_tick   Tick when first line become dirty since last flush
+ * @param statistics Hit & miss counter
+ */
+struct BlockCacheState
+{
+    struct BlockCacheLine line[BLOCK_CACHE_MAX_LINE_COUNT];
+    uint16_t hash[BLOCK_CACHE_HASH_SIZE];
+    uint16_t lru_head;
+    uint16_t lru_tail;
+    uint16_t line_count;
+    uint8_t *storage;
+    bool write_back;
+    uint16_t dirty_count;
+    uint32_t tick;
+    uint32_t oldest_dirty_tick;
+    struct BlockCacheStatistics statistics;
+} __attribute__((packed));
+
+/**
+ * Initialize block cache with given storage, line count = storage_size / BLOCK_CACHE_LINE_SIZE
+ * (capped by BLOCK_CACHE_MAX_LINE_COUNT). Before initialized, every transfer go directly to disk.
+ *
+ * @param storage      Memory for cached data, must stay valid while cache is used
+ * @param storage_size Storage size in byte
+ */
+void block_cache_initialize(void *storage, uint32_t storage_size);
+
+/**
+ * Cached read_blocks(). Line that is not cached will be read from disk and inserted as most recently used.
+ *
+ * @param ptr                   Pointer for storing reading data
+ * @param logical_block_address Block address to read data from
+ * @param block_count           How many block to read
+ */
+void block_cache_read_blocks(void *ptr, uint32_t logical_block_address, uint32_t block_count);
+
+/**
+ * Read line that is not cached yet into cache without copying to caller, each run of missing line is read with
+ * single command. Prefetched line is inserted as most recently used and counted as readahead hit / waste.
+ *
+ * @param logical_block_address First block to prefetch, rounded down to line boundary
+ * @param block_count           How many block to prefetch
+ */
+void block_cache_prefetch(uint32_t logical_block_address, uint32_t block_count);
+
+/**
+ * Cached write_blocks().
+ * Write-through: cached line is updated and data is written into disk, fully written line will be inserted into cache.
+ * Write-back: data only written into cache line (marked dirty), disk is updated on flush / eviction.
+ *
+ * @param ptr                   Pointer to data to be written
+ * @param logical_block_address Block address to write data into
+ * @param block_count           How many block to write
+ */
+void block_cache_write_blocks(const void *ptr, uint32_t logical_block_address, uint32_t block_count);
+
+/**
+ * Switch between write-through (default) and write-back mode. Switching to write-through will flush dirty line.
+ *
+ * @param enabled True for write-back mode
+ */
+void block_cache_set_write_back(bool enabled);
+
+/**
+ * Write every dirty line into disk in ascending LBA order, adjacent line coalesced into single write command
+ */
+void block_cache_flush(void);
+
+/**
+ * block_cache_flush() then ATA FLUSH CACHE, after return all written data is on media
+ */
+void block_cache_sync(void);
+
+/**
+ * Timer tick notification, safe to be called from ISR (only update counter, never touch disk)
+ */
+void block_cache_timer_tick(void);
+
+/**
+ * Flush if write-back interval since oldest dirty line is elapsed.
+ * Called from non-interrupt-sensitive kernel path (ex: end of syscall)
+ */
+void block_cache_flush_if_due(void);
+
+/**
+ * Get copy of block cache counter
+ *
+ * @param statistics Output, hit / miss / eviction / bypass counter
+ */
+void block_cache_get_statistics(struct BlockCacheStatistics *statistics);
+
+#endif
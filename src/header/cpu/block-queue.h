@@ -0,0 +1,158 @@
+#ifndef _BLOCK_QUEUE_H
+#define _BLOCK_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "disk.h"
+
+/* -- Block request queue constants -- */
+// Pending request slot count, queue is dispatched when full
+#define BLOCK_QUEUE_REQUEST_COUNT 64
+// Write data is copied into queue pool on submit, caller buffer can be reused immediately
+#define BLOCK_QUEUE_DATA_BLOCK_COUNT 128
+// Merged command size limit, adjacent request become segment of one vectored command
+#define BLOCK_QUEUE_MERGE_BLOCK_COUNT 128
+
+struct BlockRequest;
+
+// Completion callback, called after request is transferred (or coalesced into pending write)
+typedef void (*BlockRequestCallback)(struct BlockRequest *request);
+
+/**
+ * BlockRequest - One block transfer, caller owned unless submitted through block_queue_write()
+ *
+ * @param ptr                   Read target / write source, write source is copied on submit
+ * @param logical_block_address First block
+ * @param block_count           Block count
+ * @param write                 True for write, false for read
+ * @param done                  Set when transfer is completed, read target is valid after this
+ * @param callback              Optional completion callback
+ * @param context               Caller data for callback
+ * @param data_block            Internal, write data location in queue pool (block index)
+ * @param used                  Internal, slot of block_queue_write() request is in use
+ */
+struct BlockRequest
+{
+    void *ptr;
+    uint32_t logical_block_address;
+    uint32_t block_count;
+    bool write;
+    bool done;
+    BlockRequestCallback callback;
+    void *context;
+    uint16_t data_block;
+    bool used;
+} __attribute__((packed));
+
+/**
+ * BlockQueueStatistics - Counter for block request queue
+ *
+ * @param submitted Request submitted
+ * @param command   Disk command issued by dispatch
+ * @param merged    Request merged into command of adjacent request
+ * @param coalesced Write that overwrite pending write of same range, no command needed
+ */
+struct BlockQueueStatistics
+{
+    uint32_t submitted;
+    uint32_t command;
+    uint32_t merged;
+    uint32_t coalesced;
+} __attribute__((packed));
+
+/**
+ * BlockQueueState - Contain all block request queue states
+ *
+ * @param pending       Pending request, sorted by logical_block_address (elevator order)
+ * @param pending_count Pending request count
+ * @param internal      Request slot for block_queue_write()
+ * @param plug_depth    Nesting of block_queue_plug(), request is dispatched immediately when 0
+ * @param data_used     Used block count of write data pool
+ * @param statistics    Queue counter
+ */
+struct BlockQueueState
+{
+    struct BlockRequest *pending[BLOCK_QUEUE_REQUEST_COUNT];
+    uint8_t pending_count;
+    struct BlockRequest internal[BLOCK_QUEUE_REQUEST_COUNT];
+    uint8_t plug_depth;
+    uint16_t data_used;
+    struct BlockQueueStatistics statistics;
+} __attribute__((packed));
+
+/**
+ * Hold dispatch, request submitted until matching block_queue_unplug() is only queued.
+ * Can be nested.
+ */
+void block_queue_plug(void);
+
+/**
+ * Release block_queue_plug(), outermost unplug dispatch every pending request
+ */
+void block_queue_unplug(void);
+
+/**
+ * Queue request and return. Request overlapping pending request force dispatch first so order is kept.
+ * Write with same range as pending write only update pending data.
+ *
+ * @param request Request, must stay valid until done. Write source can be reused after return
+ */
+void block_queue_submit(struct BlockRequest *request);
+
+/**
+ * Dispatch pending request until request is done
+ *
+ * @param request Submitted request
+ */
+void block_queue_wait(struct BlockRequest *request);
+
+/**
+ * Dispatch every pending request in ascending LBA order, adjacent request with same direction merged into single command
+ */
+void block_queue_dispatch(void);
+
+/**
+ * Queued write_blocks() without completion handle, write larger than data pool go directly to disk
+ *
+ * @param ptr                   Data to write, can be reused after return
+ * @param logical_block_address Block address to write data into
+ * @param block_count           How many block to write
+ */
+void block_queue_write(const void *ptr, uint32_t logical_block_address, uint32_t block_count);
+
+/**
+ * Queued write_blocks_v(), segments are gathered into data pool as single request
+ *
+ * @param segment               Segment list, can be reused after return
+ * @param segment_count         Segment count
+ * @param logical_block_address First block address of range
+ */
+void block_queue_write_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address);
+
+/**
+ * Blocking read_blocks() that see pending write (pending request overlapping range is dispatched first)
+ *
+ * @param ptr                   Pointer for storing reading data
+ * @param logical_block_address Block address to read data from
+ * @param block_count           How many block to read
+ */
+void block_queue_read(void *ptr, uint32_t logical_block_address, uint32_t block_count);
+
+/**
+ * Blocking read_blocks_v() that see pending write
+ *
+ * @param segment               Segment list, filled in order starting from logical_block_address
+ * @param segment_count         Segment count
+ * @param logical_block_address First block address of range
+ */
+void block_queue_read_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address);
+
+/**
+ * Get copy of block queue counter
+ *
+ * @param statistics Output
+ */
+void block_queue_get_statistics(struct BlockQueueStatistics *statistics);
+
+#endif
@@ -12,6 +12,72 @@
 #define ATA_STATUS_DF 0x20
 #define ATA_STATUS_ERR 0x01
 
+/* -- ATA primary bus ports -- */
+#define ATA_PRIMARY_DATA 0x1F0
+#define ATA_PRIMARY_SECTOR_COUNT 0x1F2
+#define ATA_PRIMARY_LBA_LOW 0x1F3
+#define ATA_PRIMARY_LBA_MID 0x1F4
+#define ATA_PRIMARY_LBA_HIGH 0x1F5
+#define ATA_PRIMARY_DRIVE_HEAD 0x1F6
+#define ATA_PRIMARY_COMMAND_STATUS 0x1F7
+// Write: device control register (nIEN, SRST), Read: alternate status (will not ACK interrupt)
+#define ATA_PRIMARY_CONTROL 0x3F6
+
+/* -- ATA commands & control bits -- */
+#define ATA_COMMAND_READ_SECTORS 0x20
+#define ATA_COMMAND_WRITE_SECTORS 0x30
+#define ATA_COMMAND_READ_SECTORS_EXT 0x24
+#define ATA_COMMAND_WRITE_SECTORS_EXT 0x34
+#define ATA_COMMAND_READ_MULTIPLE 0xC4
+#define ATA_COMMAND_WRITE_MULTIPLE 0xC5
+#define ATA_COMMAND_READ_MULTIPLE_EXT 0x29
+#define ATA_COMMAND_WRITE_MULTIPLE_EXT 0x39
+#define ATA_COMMAND_SET_MULTIPLE_MODE 0xC6
+#define ATA_COMMAND_READ_DMA 0xC8
+#define ATA_COMMAND_WRITE_DMA 0xCA
+#define ATA_COMMAND_READ_DMA_EXT 0x25
+#define ATA_COMMAND_WRITE_DMA_EXT 0x35
+#define ATA_COMMAND_IDENTIFY 0xEC
+#define ATA_COMMAND_FLUSH_CACHE 0xE7
+#define ATA_COMMAND_FLUSH_CACHE_EXT 0xEA
+#define ATA_CONTROL_NIEN 0x02
+
+// Drive/head register value: LBA mode, master drive
+#define ATA_DRIVE_MASTER_LBA 0xE0
+#define ATA_DRIVE_MASTER_LBA48 0x40
+
+// Max block count in single command, LBA28 sector count 0 = 256 & LBA48 sector count 0 = 65536
+#define ATA_LBA28_MAX_BLOCK_COUNT 256
+#define ATA_LBA48_MAX_BLOCK_COUNT 65536
+
+/* -- ATA IDENTIFY DEVICE word index -- */
+#define ATA_IDENTIFY_MAX_MULTIPLE 47
+#define ATA_IDENTIFY_LBA28_BLOCK_COUNT 60
+#define ATA_IDENTIFY_COMMAND_SET_SUPPORT 83
+#define ATA_IDENTIFY_LBA48_BLOCK_COUNT 100
+#define ATA_IDENTIFY_LBA48_SUPPORTED (1 << 10)
+
+/* -- PCI IDE bus master (primary channel, offset from BAR4) -- */
+#define ATA_BM_COMMAND 0x0
+#define ATA_BM_STATUS 0x2
+#define ATA_BM_PRDT_ADDRESS 0x4
+
+#define ATA_BM_COMMAND_START 0x01
+#define ATA_BM_COMMAND_READ 0x08 // Direction bit, set when transfer is device to memory
+#define ATA_BM_STATUS_ACTIVE 0x01
+#define ATA_BM_STATUS_ERROR 0x02
+#define ATA_BM_STATUS_IRQ 0x04
+// Programming interface bit 7, IDE controller support bus mastering
+#define ATA_PROG_IF_BUS_MASTER 0x80
+
+#define ATA_PRD_END_OF_TABLE 0x8000
+#define ATA_PRD_MAX_BYTE_COUNT 0x10000
+// PRD entry count, 256 entry * 8 byte = 2 KiB table, up to 16 MiB of scattered physical region per command
+#define ATA_PRD_TABLE_SIZE 256
+// Bounce buffer size, used when target memory cannot be translated into physical address
+#define ATA_DMA_BUFFER_SIZE 0x10000
+#define ATA_DMA_MAX_BLOCK_COUNT (ATA_DMA_BUFFER_SIZE / BLOCK_SIZE)
+
 #define BLOCK_SIZE 512
 #define HALF_BLOCK_SIZE (BLOCK_SIZE / 2)
 
@@ -22,26 +88,204 @@ struct BlockBuffer
 } __attribute__((packed));
 
 /**
- * ATA PIO logical block address read blocks. Will blocking until read is completed.
+ * BlockSegment - One memory segment of vectored transfer, segments are mapped to consecutive blocks on disk
+ *
+ * @param ptr         Memory of segment, size of block_count * BLOCK_SIZE
+ * @param block_count Block count of segment, 0 is allowed and skipped
+ */
+struct BlockSegment
+{
+    void *ptr;
+    uint32_t block_count;
+} __attribute__((packed));
+
+/**
+ * Physical Region Descriptor, entry of bus master PRD table
+ *
+ * @param physical_address Physical address of memory region, must be 2-byte aligned and not crossing 64 KiB boundary
+ * @param byte_count       Region size in byte, 0 mean 64 KiB
+ * @param flag             ATA_PRD_END_OF_TABLE for last entry
+ */
+struct ATAPhysicalRegionDescriptor
+{
+    uint32_t physical_address;
+    uint16_t byte_count;
+    uint16_t flag;
+} __attribute__((packed));
+
+/**
+ * ATADriveInformation - Drive capability, filled from IDENTIFY DEVICE during initialize_disk()
+ *
+ * @param present              True if IDENTIFY returned ATA device
+ * @param lba48                Drive support 48-bit LBA (READ / WRITE SECTORS EXT)
+ * @param block_count          Addressable block count of drive
+ * @param multiple_block_count Block count per DRQ data block for READ / WRITE MULTIPLE, 1 mean not used
+ */
+struct ATADriveInformation
+{
+    bool present;
+    bool lba48;
+    uint32_t block_count;
+    uint16_t multiple_block_count;
+} __attribute__((packed));
+
+// BlockDevice.irq value for backend without interrupt, completion is polled
+#define BLOCK_DEVICE_IRQ_NONE 0xFF
+
+/**
+ * BlockDevice - Block backend behind read_blocks() / write_blocks(), selected by initialize_disk()
+ *
+ * @param read         Vectored read, return after data is in memory (or queued when batch is open)
+ * @param write        Vectored write, return after data is sent to device (or queued when batch is open)
+ * @param flush        Commit device write cache into media
+ * @param batch_begin  Optional, command issued until batch_end() may stay outstanding on device
+ * @param batch_end    Optional, wait every outstanding command
+ * @param irq_activate Enable interrupt completion path
+ * @param isr          Interrupt service routine, must ACK device & PIC
+ * @param irq          Legacy PIC IRQ number, BLOCK_DEVICE_IRQ_NONE if not used
+ * @param block_count  Addressable block count, 0 if no disk found
+ */
+struct BlockDevice
+{
+    void (*read)(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address);
+    void (*write)(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address);
+    void (*flush)(void);
+    void (*batch_begin)(void);
+    void (*batch_end)(void);
+    void (*irq_activate)(void);
+    void (*isr)(void);
+    uint8_t irq;
+    uint32_t block_count;
+} __attribute__((packed));
+
+/**
+ * Select block backend. Legacy virtio-blk PCI device is preferred, then AHCI SATA disk when PCI AHCI controller
+ * with attached disk is found, otherwise identify primary master ATA drive (LBA48 & READ / WRITE MULTIPLE support, SET MULTIPLE MODE),
+ * then probe PCI IDE controller and enable bus master DMA if supported.
+ * Without compatible controller, read_blocks() and write_blocks() keep using ATA PIO
+ */
+void initialize_disk(void);
+
+/**
+ * Legacy PIC IRQ used by selected backend (IRQ14 for ATA), call after initialize_disk()
+ * @return IRQ number, BLOCK_DEVICE_IRQ_NONE if backend does not use interrupt
+ */
+uint8_t disk_irq(void);
+
+/**
+ * Enable interrupt completion path of selected backend. After this, read_blocks() and write_blocks()
+ * will HLT the CPU while waiting for the drive instead of spinning on status register.
+ * Call after PIC IRQ & IDT is ready.
+ */
+void disk_irq_activate(void);
+
+/**
+ * Disk interrupt service routine, will be called from main_interrupt_handler() for disk_irq()
+ */
+void disk_isr(void);
+
+/**
+ * Open command batch, backend with command queue (AHCI NCQ) may leave command issued by
+ * read_blocks() / write_blocks() outstanding until disk_batch_end(). Memory of every segment must stay
+ * valid and request inside batch must not overlap write of same batch.
+ */
+void disk_batch_begin(void);
+
+/**
+ * Close command batch, blocking until every outstanding command is completed
+ */
+void disk_batch_end(void);
+
+/**
+ * Pointer to block at position (index, offset) of segment list, empty segment is skipped
+ *
+ * @param segment Segment list
+ * @param index   In/out, segment index
+ * @param offset  In/out, block offset inside segment
+ * @return        Block pointer
+ */
+uint8_t *block_segment_pointer(const struct BlockSegment *segment, uint32_t *index, uint32_t *offset);
+
+/**
+ * Move position (index, offset) of segment list forward
+ *
+ * @param segment     Segment list
+ * @param index       In/out, segment index
+ * @param offset      In/out, block offset inside segment
+ * @param block_count Block count to skip
+ */
+void block_segment_advance(const struct BlockSegment *segment, uint32_t *index, uint32_t *offset, uint32_t block_count);
+
+/**
+ * Copy blocks between segment list starting at (index, offset) and contiguous buffer
+ *
+ * @param segment     Segment list
+ * @param index       Segment index
+ * @param offset      Block offset inside segment
+ * @param buffer      Contiguous buffer
+ * @param block_count Block count to copy
+ * @param to_buffer   True to gather segment into buffer, false to scatter buffer into segment
+ */
+void block_segment_copy(const struct BlockSegment *segment, uint32_t index, uint32_t offset,
+                        uint8_t *buffer, uint32_t block_count, bool to_buffer);
+
+/**
+ * ATA logical block address read blocks. Will blocking until read is completed.
+ * Use backend selected by initialize_disk(), for ATA: bus master DMA when capable controller found, otherwise ATA PIO.
  * Note: ATA PIO will use 2-bytes per read/write operation.
  * Recommended to use struct BlockBuffer
  *
  * @param ptr                   Pointer for storing reading data, this pointer should point to already allocated memory location.
  *                              With allocated size positive integer multiple of BLOCK_SIZE, ex: buf[1024]
  * @param logical_block_address Block address to read data from. Use LBA addressing
- * @param block_count           How many block to read, starting from block logical_block_address to lba-1
+ * @param block_count           How many block to read, starting from block logical_block_address to lba-1.
+ *                              Large count is split into as few command as possible (LBA48 up to 65536 block per command)
  */
-void read_blocks(void *ptr, uint32_t logical_block_address, uint8_t block_count);
+void read_blocks(void *ptr, uint32_t logical_block_address, uint32_t block_count);
 
 /**
- * ATA PIO logical block address write blocks. Will blocking until write is completed.
+ * ATA logical block address write blocks. Will blocking until write is completed.
+ * Use backend selected by initialize_disk(), for ATA: bus master DMA when capable controller found, otherwise ATA PIO.
  * Note: ATA PIO will use 2-bytes per read/write operation.
  * Recommended to use struct BlockBuffer
  *
  * @param ptr                   Pointer to data that to be written into disk. Memory pointed should be positive integer multiple of BLOCK_SIZE
  * @param logical_block_address Block address to write data into. Use LBA addressing
- * @param block_count           How many block to write, starting from block logical_block_address to lba-1
+ * @param block_count           How many block to write, starting from block logical_block_address to lba-1.
+ *                              Large count is split into as few command as possible (LBA48 up to 65536 block per command)
+ */
+void write_blocks(const void *ptr, uint32_t logical_block_address, uint32_t block_count);
+
+/**
+ * Vectored read_blocks(), scatter one LBA range into multiple memory segment.
+ * With bus master DMA every segment become PRD entry of same command, so whole range is read
+ * with as few command as single contiguous read_blocks()
+ *
+ * @param segment               Segment list, filled in order starting from logical_block_address
+ * @param segment_count         Segment count
+ * @param logical_block_address First block address of range
+ */
+void read_blocks_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address);
+
+/**
+ * Vectored write_blocks(), gather multiple memory segment into one LBA range.
+ * With bus master DMA every segment become PRD entry of same command
+ *
+ * @param segment               Segment list, written in order starting from logical_block_address
+ * @param segment_count         Segment count
+ * @param logical_block_address First block address of range
+ */
+void write_blocks_v(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address);
+
+/**
+ * Disk size from IDENTIFY
+ * @return Addressable block count, 0 if no drive found
+ */
+uint32_t disk_block_count(void);
+
+/**
+ * FLUSH CACHE on selected backend, will blocking until drive write cache is committed into media
  */
-void write_blocks(const void *ptr, uint32_t logical_block_address, uint8_t block_count);
+void flush_blocks(void);
 
-#endif
\ No newline at end of file
+#endif
@@ -28,11 +28,69 @@
 #define FAT_CLUSTER_NUMBER 1
 #define ROOT_CLUSTER_NUMBER 2
 
+/* -- FAT geometry constants -- */
+// FileAllocationTable is paged per block, each block contain FAT32_FAT_ENTRY_PER_BLOCK entry
+#define FAT32_FAT_ENTRY_PER_BLOCK (BLOCK_SIZE / sizeof(uint32_t))
+// FAT cluster k is located at FAT_CLUSTER_NUMBER (k = 0) or ROOT_CLUSTER_NUMBER + k (k >= 1)
+#define FAT32_FAT_ENTRY_PER_CLUSTER CLUSTER_MAP_SIZE
+// Upper bound of volume size in cluster (1 GiB), free bitmap is statically allocated
+#define FAT32_MAX_CLUSTER_COUNT 0x80000
+#define FAT32_MAX_FAT_BLOCK_COUNT (FAT32_MAX_CLUSTER_COUNT / FAT32_FAT_ENTRY_PER_BLOCK)
+// Resident FAT block slot, direct-mapped by FAT block index
+#define FAT32_FAT_WINDOW_SIZE 16
+// Free run search stop after this many cluster once any free run is found
+#define FAT32_FREE_RUN_SEARCH_WINDOW 4096
+
+// Geometry is stored in unused area of boot sector, zero geometry means legacy 1 FAT cluster volume
+#define FAT32_GEOMETRY_OFFSET 256
+#define FAT32_GEOMETRY_SIZE 64
+
+/* -- FSInfo constants -- */
+// FSInfo is located at block right after boot sector, still inside cluster 0
+#define FSINFO_SECTOR 1
+#define FSINFO_LEAD_SIGNATURE 0x41615252
+#define FSINFO_STRUCT_SIGNATURE 0x61417272
+#define FSINFO_TRAIL_SIGNATURE 0xAA550000
+#define FSINFO_UNKNOWN 0xFFFFFFFF
+
 /* -- FAT32 DirectoryEntry constants -- */
 #define ATTR_SUBDIRECTORY 0b00010000
 #define ATTR_ARCHIVE 0b00100000
 #define UATTR_NOT_EMPTY 0b10101010
 
+// Directory entry per cluster, entry-0 (itself) and entry-1 (parent) only exist in first directory cluster
+#define FAT32_DIRECTORY_ENTRY_COUNT (CLUSTER_SIZE / sizeof(struct FAT32DirectoryEntry))
+#define FAT32_DIRECTORY_RESERVED_ENTRY_COUNT 2
+// Free slot hint slot, direct-mapped by directory first cluster
+#define FAT32_DIRECTORY_HINT_COUNT 32
+// Dentry cache slot count (direct-mapped by hash of parent cluster & name), must be power of two
+#define FAT32_DENTRY_CACHE_SIZE 1024
+// Packed name key, name[8] followed by ext[3]
+#define FAT32_DENTRY_NAME_SIZE 11
+// resolve_path() limit, path length and directory depth remembered for ".."
+#define FAT32_PATH_MAX_LENGTH 256
+#define FAT32_PATH_MAX_DEPTH 32
+// Extent map cache, direct-mapped by file first cluster, each holding up to FAT32_EXTENT_MAP_SIZE run
+#define FAT32_EXTENT_MAP_COUNT 16
+#define FAT32_EXTENT_MAP_SIZE 64
+// Readahead window (cluster) for sequential read, grow while prefetched cluster is consumed and shrink on random access
+#define FAT32_READAHEAD_MIN 4
+#define FAT32_READAHEAD_MAX 32
+// Directory cluster prefetched when resolve_path() end at a directory
+#define FAT32_READAHEAD_DIRECTORY 8
+// Open-file table size, descriptor is index into the table
+#define FAT32_OPEN_FILE_COUNT 16
+// seek_file() whence
+#define FAT32_SEEK_SET 0
+#define FAT32_SEEK_CURRENT 1
+#define FAT32_SEEK_END 2
+// Maximum extra reference per cluster stored in refcount table
+#define FAT32_REFCOUNT_MAX 0xFF
+// list_directory() cookie after last entry is returned
+#define FAT32_LIST_COOKIE_END 0xFFFFFFFF
+// find_entries() pattern, "name.ext" with '*' & '?' wildcard, null-terminated
+#define FAT32_FIND_PATTERN_LENGTH 13
+
 // Boot sector signature for this file system "FAT32 - IF2230 edition"
 extern const uint8_t fs_signature[BLOCK_SIZE];
 
@@ -99,18 +157,197 @@ struct FAT32DirectoryTable
     struct FAT32DirectoryEntry table[CLUSTER_SIZE / sizeof(struct FAT32DirectoryEntry)];
 } __attribute__((packed));
 
+/**
+ * FAT32DirectoryPosition - Location of a directory entry within chained directory
+ * @param cluster_number Directory cluster containing the entry
+ * @param cluster_index  Position of cluster_number in directory chain, 0 is first cluster
+ * @param slot           Entry index within FAT32DirectoryTable
+ */
+struct FAT32DirectoryPosition
+{
+    uint32_t cluster_number;
+    uint32_t cluster_index;
+    uint8_t slot;
+} __attribute__((packed));
+
+/**
+ * FAT32DirectorySlotHint - Free slot search start of a directory, every slot before position is in use
+ * @param directory_cluster Directory first cluster, 0 if hint is unused
+ * @param position          First possibly free slot
+ */
+struct FAT32DirectorySlotHint
+{
+    uint32_t directory_cluster;
+    struct FAT32DirectoryPosition position;
+} __attribute__((packed));
+
+/**
+ * FAT32DentryCacheEntry - Cached result of name lookup in a directory
+ * @param directory_cluster Directory first cluster
+ * @param name              Packed key, name followed by ext
+ * @param valid             True if slot is used
+ * @param negative          True if name does not exist in directory, position & entry is unused
+ * @param position          Location of the entry in directory chain
+ * @param entry             Copy of on-disk directory entry
+ */
+struct FAT32DentryCacheEntry
+{
+    uint32_t directory_cluster;
+    char name[FAT32_DENTRY_NAME_SIZE];
+    bool valid;
+    bool negative;
+    struct FAT32DirectoryPosition position;
+    struct FAT32DirectoryEntry entry;
+} __attribute__((packed));
+
+/**
+ * FAT32Extent - Contiguous run of cluster in a file chain
+ * @param file_cluster_index Cluster index in file (file offset / CLUSTER_SIZE) of first cluster of the run
+ * @param cluster_number     First cluster number of the run
+ * @param length             Run length in cluster
+ */
+struct FAT32Extent
+{
+    uint32_t file_cluster_index;
+    uint32_t cluster_number;
+    uint32_t length;
+} __attribute__((packed));
+
+/**
+ * FAT32ExtentMap - Cached extent list of a file, sorted by file_cluster_index
+ * @param first_cluster File first cluster, identify the file
+ * @param cluster_count Cluster count covered by extent
+ * @param extent_count  Used extent count
+ * @param valid         True if slot is used
+ * @param complete      True if extent cover whole chain, false if chain has more run than FAT32_EXTENT_MAP_SIZE
+ * @param readahead_next   Cluster index expected by next sequential read
+ * @param readahead_end    Cluster index after last prefetched cluster
+ * @param readahead_window Current readahead window in cluster
+ * @param extent        Extent list
+ */
+struct FAT32ExtentMap
+{
+    uint32_t first_cluster;
+    uint32_t cluster_count;
+    uint16_t extent_count;
+    bool valid;
+    bool complete;
+    uint32_t readahead_next;
+    uint32_t readahead_end;
+    uint8_t readahead_window;
+    struct FAT32Extent extent[FAT32_EXTENT_MAP_SIZE];
+} __attribute__((packed));
+
+/**
+ * FAT32FileCursor - Cluster of last accessed position, so sequential access continue without lookup
+ * @param cluster_index  Cluster index in file
+ * @param cluster_number Cluster number of cluster_index, 0 if cursor is not set
+ */
+struct FAT32FileCursor
+{
+    uint32_t cluster_index;
+    uint32_t cluster_number;
+} __attribute__((packed));
+
+/**
+ * FAT32OpenFile - Open-file table entry
+ * @param used                  True if descriptor is open
+ * @param parent_cluster_number Directory containing the file
+ * @param position              Location of file entry in directory
+ * @param entry                 Copy of file directory entry, filesize kept up to date
+ * @param offset                Current byte position
+ * @param cursor                Cluster of last accessed position
+ */
+struct FAT32OpenFile
+{
+    bool used;
+    uint32_t parent_cluster_number;
+    struct FAT32DirectoryPosition position;
+    struct FAT32DirectoryEntry entry;
+    uint32_t offset;
+    struct FAT32FileCursor cursor;
+} __attribute__((packed));
+
+/**
+ * FAT32Geometry - Volume layout, located at FAT32_GEOMETRY_OFFSET of boot sector
+ * @param cluster_count     Volume size in cluster, also FAT entry count
+ * @param fat_cluster_count Cluster count used by FileAllocationTable
+ * @param refcount_cluster  First cluster of refcount table (1 byte extra reference count per cluster), 0 if not created
+ * @param reserved          Padding to FAT32_GEOMETRY_SIZE, must be zero
+ */
+struct FAT32Geometry
+{
+    uint32_t cluster_count;
+    uint32_t fat_cluster_count;
+    uint32_t refcount_cluster;
+    uint8_t reserved[FAT32_GEOMETRY_SIZE - 3 * sizeof(uint32_t)];
+} __attribute__((packed));
+
+/**
+ * FAT32FATWindowSlot - Resident copy of one FAT block
+ * @param block FAT block index, entry of cluster c is at block c / FAT32_FAT_ENTRY_PER_BLOCK
+ * @param valid True if entry contain data of block
+ * @param dirty True if entry is modified and not written into block cache yet
+ * @param entry FAT entry of this block
+ */
+struct FAT32FATWindowSlot
+{
+    uint32_t block;
+    bool valid;
+    bool dirty;
+    uint32_t entry[FAT32_FAT_ENTRY_PER_BLOCK];
+} __attribute__((packed));
+
+/**
+ * FAT32 FSInfo sector, same layout as FAT32 standard FSInfo
+ * @param lead_signature   Must be FSINFO_LEAD_SIGNATURE
+ * @param struct_signature Must be FSINFO_STRUCT_SIGNATURE
+ * @param free_count       Free cluster count, FSINFO_UNKNOWN if not known
+ * @param next_free        Cluster number to start searching free cluster, FSINFO_UNKNOWN if not known
+ * @param trail_signature  Must be FSINFO_TRAIL_SIGNATURE
+ */
+struct FAT32FSInfo
+{
+    uint32_t lead_signature;
+    uint8_t reserved_1[480];
+    uint32_t struct_signature;
+    uint32_t free_count;
+    uint32_t next_free;
+    uint8_t reserved_2[12];
+    uint32_t trail_signature;
+} __attribute__((packed));
+
 /* -- FAT32 Driver -- */
 
 /**
  * FAT32DriverState - Contain all driver states
- *
- * @param fat_table     FAT of the system, will be loaded during initialize_filesystem_fat32()
+ * @param geometry      Volume layout, loaded from boot sector during initialize_filesystem_fat32()
+ * @param fat_window    Resident FAT block, FileAllocationTable is paged in per block through block cache
+ * @param free_bitmap   Bit set if cluster is free, only valid for FAT block marked in free_bitmap_valid_mask
+ * @param free_bitmap_valid_mask Bit i set if free_bitmap of FAT block i is built, built lazily when FSInfo is valid
+ * @param free_cluster_count     Running free cluster count
+ * @param next_free_cluster      Cluster number where next free cluster search is started
+ * @param fsinfo_dirty           True if free_cluster_count / next_free_cluster is not written into FSInfo yet
+ * @param directory_hint         In-memory free slot hint per directory
+ * @param dentry_cache           Name lookup cache, updated by write / delete / preallocate
+ * @param extent_map             File extent cache for offset lookup, updated when chain is extended or freed
+ * @param open_file              Open-file table
  * @param dir_table_buf Buffer for directory table
  * @param cluster_buf   Buffer for cluster, can be used for temp var
  */
 struct FAT32DriverState
 {
-    struct FAT32FileAllocationTable fat_table;
+    struct FAT32Geometry geometry;
+    struct FAT32FATWindowSlot fat_window[FAT32_FAT_WINDOW_SIZE];
+    uint32_t free_bitmap[FAT32_MAX_CLUSTER_COUNT / 32];
+    uint32_t free_bitmap_valid_mask[FAT32_MAX_FAT_BLOCK_COUNT / 32];
+    uint32_t free_cluster_count;
+    uint32_t next_free_cluster;
+    bool fsinfo_dirty;
+    struct FAT32DirectorySlotHint directory_hint[FAT32_DIRECTORY_HINT_COUNT];
+    struct FAT32DentryCacheEntry dentry_cache[FAT32_DENTRY_CACHE_SIZE];
+    struct FAT32ExtentMap extent_map[FAT32_EXTENT_MAP_COUNT];
+    struct FAT32OpenFile open_file[FAT32_OPEN_FILE_COUNT];
     struct FAT32DirectoryTable dir_table_buf;
     struct ClusterBuffer cluster_buf;
 } __attribute__((packed));
@@ -133,6 +370,153 @@ struct FAT32DriverRequest
     uint32_t buffer_size;
 } __attribute__((packed));
 
+/**
+ * FAT32PathRequest - Parameter for resolve_path()
+ * @param path                 Null-terminated slash-separated path, absolute if started with '/'.
+ *                             Component is name without ext, "." and ".." is supported
+ * @param start_cluster_number Directory cluster for relative path
+ */
+struct FAT32PathRequest
+{
+    const char *path;
+    uint32_t start_cluster_number;
+} __attribute__((packed));
+
+/**
+ * FAT32PathEntry - Final entry of resolved path
+ * @param name                  Entry name, for directory same as its entry-0
+ * @param ext                   Entry ext
+ * @param attribute             Entry attribute, ATTR_SUBDIRECTORY for directory
+ * @param cluster_number        Entry first cluster
+ * @param parent_cluster_number Directory containing the entry, usable as FAT32DriverRequest parent_cluster_number
+ * @param filesize              Entry filesize, 0 for directory
+ */
+struct FAT32PathEntry
+{
+    char name[8];
+    char ext[3];
+    uint8_t attribute;
+    uint32_t cluster_number;
+    uint32_t parent_cluster_number;
+    uint32_t filesize;
+} __attribute__((packed));
+
+/**
+ * FAT32RangeRequest - Parameter for read_range() / write_range()
+ * @param request          name, ext, and parent_cluster_number identify the file,
+ *                         buf & buffer_size is the range data & length
+ * @param offset           Byte offset in file where the range start
+ * @param transferred_size Output, byte count actually read / written
+ */
+struct FAT32RangeRequest
+{
+    struct FAT32DriverRequest request;
+    uint32_t offset;
+    uint32_t transferred_size;
+} __attribute__((packed));
+
+/**
+ * FAT32FileRequest - Parameter for read_file() / write_file()
+ * @param descriptor       Descriptor returned by open_file()
+ * @param buf              Data buffer
+ * @param size             Byte count to read / write
+ * @param transferred_size Output, byte count actually read / written
+ */
+struct FAT32FileRequest
+{
+    uint8_t descriptor;
+    void *buf;
+    uint32_t size;
+    uint32_t transferred_size;
+} __attribute__((packed));
+
+/**
+ * FAT32SeekRequest - Parameter for seek_file()
+ * @param descriptor Descriptor returned by open_file()
+ * @param offset     Signed byte offset relative to whence
+ * @param whence     FAT32_SEEK_SET, FAT32_SEEK_CURRENT, or FAT32_SEEK_END
+ * @param position   Output, new byte position
+ */
+struct FAT32SeekRequest
+{
+    uint8_t descriptor;
+    int32_t offset;
+    uint8_t whence;
+    uint32_t position;
+} __attribute__((packed));
+
+/**
+ * FAT32DirectoryRecord - Compact directory entry returned by list_directory()
+ * @param name           Entry name
+ * @param ext            Entry ext
+ * @param attribute      Entry attribute, ATTR_SUBDIRECTORY for directory
+ * @param cluster_number Entry first cluster
+ * @param filesize       Entry filesize
+ */
+struct FAT32DirectoryRecord
+{
+    char name[8];
+    char ext[3];
+    uint8_t attribute;
+    uint32_t cluster_number;
+    uint32_t filesize;
+} __attribute__((packed));
+
+/**
+ * FAT32ListRequest - Parameter for list_directory()
+ * @param directory_cluster Directory first cluster to list
+ * @param buf               Record buffer
+ * @param record_capacity   Record count that fit in buf
+ * @param cookie            Resume position, 0 for first call. Updated after call, FAT32_LIST_COOKIE_END if no entry left
+ * @param prefix            Only entry with name starting with prefix is returned
+ * @param prefix_length     Prefix length, 0 to return every entry
+ * @param record_count      Output, record count written into buf
+ */
+struct FAT32ListRequest
+{
+    uint32_t directory_cluster;
+    struct FAT32DirectoryRecord *buf;
+    uint32_t record_capacity;
+    uint32_t cookie;
+    char prefix[8];
+    uint8_t prefix_length;
+    uint32_t record_count;
+} __attribute__((packed));
+
+/**
+ * FAT32FindRequest - Parameter & walk state for find_entries()
+ * Matched path ("/dir/name" relative to root_cluster) is written to buf, each terminated with '\0'.
+ * Zero every walk state field before first call, keep it untouched between call.
+ *
+ * @param root_cluster  Root directory of subtree to search
+ * @param pattern       Name pattern, '*' match any sequence and '?' match one character
+ * @param buf           Path output buffer
+ * @param buffer_size   buf size in byte, must fit at least one path
+ * @param match_count   Output, path count written into buf
+ * @param used_size     Output, byte used in buf
+ * @param done          Output, true if whole subtree is visited
+ * @param depth         Walk state, directory stack depth
+ * @param cluster       Walk state, directory first cluster for each depth
+ * @param cookie        Walk state, next entry position (cluster index * entry count + slot) for each depth
+ * @param path_length   Walk state, path length of directory for each depth
+ * @param path          Walk state, path of deepest directory
+ */
+struct FAT32FindRequest
+{
+    uint32_t root_cluster;
+    char pattern[FAT32_FIND_PATTERN_LENGTH];
+    char *buf;
+    uint32_t buffer_size;
+    uint32_t match_count;
+    uint32_t used_size;
+    bool done;
+    uint8_t depth;
+    uint32_t cluster[FAT32_PATH_MAX_DEPTH];
+    uint32_t cookie[FAT32_PATH_MAX_DEPTH];
+    uint16_t path_length[FAT32_PATH_MAX_DEPTH];
+    char path[FAT32_PATH_MAX_LENGTH];
+} __attribute__((packed));
+
 /* -- Driver Interfaces -- */
 
 /**
@@ -162,37 +546,44 @@ void init_directory_table(struct FAT32DirectoryTable *dir_table, char *name, uin
 bool is_empty_storage(void);
 
 /**
- * Create new FAT32 file system. Will write fs_signature into boot sector and
- * proper FileAllocationTable (contain CLUSTER_0_VALUE, CLUSTER_1_VALUE,
- * and initialized root directory) into cluster number 1
+ * Create new FAT32 file system sized from disk_block_count(). Will write fs_signature & geometry into boot sector and
+ * proper FileAllocationTable (contain CLUSTER_0_VALUE, CLUSTER_1_VALUE, FAT clusters,
+ * and initialized root directory) into cluster number 1, ROOT_CLUSTER_NUMBER + 1, ...
  */
 void create_fat32(void);
 
 /**
  * Initialize file system driver state, if is_empty_storage() then create_fat32()
- * Else, read and cache entire FileAllocationTable (located at cluster number 1) into driver state
+ * Else, load geometry from boot sector, FileAllocationTable is paged in on demand.
+ * Free cluster count & next free hint is taken from FSInfo, FAT is only scanned if FSInfo is invalid
  */
 void initialize_filesystem_fat32(void);
 
 /**
- * Write cluster operation, wrapper for write_blocks().
+ * Write cluster operation, wrapper for block_cache_write_blocks().
  * Recommended to use struct ClusterBuffer
  *
  * @param ptr            Pointer to source data
  * @param cluster_number Cluster number to write
- * @param cluster_count  Cluster count to write, due limitation of write_blocks block_count 255 => max cluster_count = 63
+ * @param cluster_count  Cluster count to write
  */
-void write_clusters(const void *ptr, uint32_t cluster_number, uint8_t cluster_count);
+void write_clusters(const void *ptr, uint32_t cluster_number, uint32_t cluster_count);
 
 /**
- * Read cluster operation, wrapper for read_blocks().
+ * Read cluster operation, wrapper for block_cache_read_blocks().
  * Recommended to use struct ClusterBuffer
  *
  * @param ptr            Pointer to buffer for reading
  * @param cluster_number Cluster number to read
- * @param cluster_count  Cluster count to read, due limitation of read_blocks block_count 255 => max cluster_count = 63
+ * @param cluster_count  Cluster count to read
+ */
+void read_clusters(void *ptr, uint32_t cluster_number, uint32_t cluster_count);
+
+/**
+ * Free cluster count, maintained on every FAT update so no scan is needed
+ * @return Free cluster count
  */
-void read_clusters(void *ptr, uint32_t cluster_number, uint8_t cluster_count);
+uint32_t fat32_get_free_cluster_count(void);
 
 /* -- CRUD Operation -- */
 
@@ -204,10 +595,19 @@ void read_clusters(void *ptr, uint32_t cluster_number, uint8_t cluster_count);
  *                ext is unused,
  *                parent_cluster_number is target directory table to read,
  *                buffer_size must be exactly sizeof(struct FAT32DirectoryTable)
+ * Only first directory cluster is read, use read_directory_cluster() for the rest
  * @return Error code: 0 success - 1 not a folder - 2 not found - -1 unknown
  */
 int8_t read_directory(struct FAT32DriverRequest request);
 
+/**
+ * FAT32 Folder / Directory read by cluster, directory may span multiple chained cluster
+ * @param request       Same as read_directory()
+ * @param cluster_index Directory cluster to read, 0 is first cluster (containing entry-0 and entry-1)
+ * @return Error code: 0 success - 1 not a folder - 2 not found - 3 cluster_index past end of directory - -1 unknown
+ */
+int8_t read_directory_cluster(struct FAT32DriverRequest request, uint32_t cluster_index);
+
 /**
  * FAT32 read, read a file from file system.
  *
@@ -232,4 +632,124 @@ int8_t write(struct FAT32DriverRequest request);
  */
 int8_t delete(struct FAT32DriverRequest request);
 
-#endif
\ No newline at end of file
+/**
+ * FAT32 preallocate, reserve cluster for known final size so later write stay contiguous.
+ * Filesize is not changed, new file is created with filesize 0 if not exist.
+ * @param request buf is unused, buffer_size is final size in byte
+ * @return Error code: 0 success - 1 is a folder - 2 invalid parent cluster - -1 not enough cluster / unknown
+ */
+int8_t preallocate(struct FAT32DriverRequest request);
+
+/**
+ * Resolve slash-separated path into its final entry with single call, every component is looked up with dentry cache.
+ * Path that end with directory ("/", ".", "..", "a/b") return the directory itself.
+ *
+ * @param request Path and start directory for relative path
+ * @param result  Output, filled when success
+ * @return Error code: 0 success - 1 component after a file - 2 not found - -1 invalid path (too long / name > 8 char)
+ */
+int8_t resolve_path(struct FAT32PathRequest request, struct FAT32PathEntry *result);
+
+/**
+ * FAT32 positional read, read at most buffer_size byte starting at offset.
+ * Only cluster covering the range is read, reading at / past end of file transfer 0 byte.
+ *
+ * @param range Range request, transferred_size is filled with byte count read
+ * @return Error code: 0 success - 1 is a folder - 2 not found - -1 unknown
+ */
+int8_t read_range(struct FAT32RangeRequest *range);
+
+/**
+ * FAT32 positional write, overwrite buffer_size byte starting at offset of existing file.
+ * File is extended (and filesize updated) if range go past end of file, offset == filesize append into file.
+ *
+ * @param range Range request, transferred_size is filled with byte count written
+ * @return Error code: 0 success - 1 is a folder - 2 not found - 3 offset past end of file - -1 not enough cluster / unknown
+ */
+int8_t write_range(struct FAT32RangeRequest *range);
+
+/**
+ * Open a file, resolved directory entry is kept in open-file table so later operation skip name lookup.
+ * Cursor start at offset 0. Deleting the file close every descriptor of it.
+ *
+ * @param request    name, ext, and parent_cluster_number identify the file, buf & buffer_size is unused
+ * @param descriptor Output, file descriptor
+ * @return Error code: 0 success - 1 is a folder - 2 not found - -1 open-file table full
+ */
+int8_t open_file(struct FAT32DriverRequest request, uint8_t *descriptor);
+
+/**
+ * Close a file descriptor
+ *
+ * @param descriptor File descriptor
+ * @return Error code: 0 success - 2 invalid descriptor
+ */
+int8_t close_file(uint8_t descriptor);
+
+/**
+ * Read from descriptor cursor, cursor advance by byte count read. Reading at end of file transfer 0 byte.
+ *
+ * @param request Read request, transferred_size is filled with byte count read
+ * @return Error code: 0 success - 2 invalid descriptor
+ */
+int8_t read_file(struct FAT32FileRequest *request);
+
+/**
+ * Write at descriptor cursor, file is extended if needed. Cursor advance by byte count written.
+ *
+ * @param request Write request, transferred_size is filled with byte count written
+ * @return Error code: 0 success - 2 invalid descriptor - -1 not enough cluster / unknown
+ */
+int8_t write_file(struct FAT32FileRequest *request);
+
+/**
+ * Move descriptor cursor
+ *
+ * @param request Seek request, position is filled with new cursor position
+ * @return Error code: 0 success - 2 invalid descriptor - 3 position before start / past end of file - -1 invalid whence
+ */
+int8_t seek_file(struct FAT32SeekRequest *request);
+
+/**
+ * FAT32 rename, move an entry into destination directory and / or rename it without copying file data.
+ * Only affected directory entry is rewritten, moved folder also get its entry-0 name and ".." entry updated.
+ *
+ * @param source      name, ext, and parent_cluster_number of existing entry, buf & buffer_size is unused
+ * @param destination New name, ext, and parent_cluster_number, buf & buffer_size is unused
+ * @return Error code: 0 success - 1 source not found - 2 invalid destination parent - 3 destination already exist -
+ *                     4 folder moved into itself - -1 not enough cluster / unknown
+ */
+int8_t rename_entry(struct FAT32DriverRequest source, struct FAT32DriverRequest destination);
+
+/**
+ * FAT32 clone, create destination file sharing source cluster chain (reflink) without copying data.
+ * Shared cluster is copied lazily when either file is modified, deleting one file keep the other intact.
+ * Refcount table is created on first clone.
+ *
+ * @param source      name, ext, and parent_cluster_number of existing file, buf & buffer_size is unused
+ * @param destination New name, ext, and parent_cluster_number, buf & buffer_size is unused
+ * @return Error code: 0 success - 1 source not found / is a folder - 2 invalid destination parent -
+ *                     3 destination already exist - -1 not enough cluster / too many clone
+ */
+int8_t clone_entry(struct FAT32DriverRequest source, struct FAT32DriverRequest destination);
+
+/**
+ * List populated entry of a directory (entry-0 and entry-1 excluded) as compact record, filtered by name prefix.
+ * Call repeatedly with returned cookie until cookie is FAT32_LIST_COOKIE_END.
+ *
+ * @param request List request, record_count and cookie is updated
+ * @return Error code: 0 success - 2 not a directory - -1 invalid prefix length
+ */
+int8_t list_directory(struct FAT32ListRequest *request);
+
+/**
+ * Search subtree for entry with name matching pattern, depth-first.
+ * Call repeatedly with same request until done, each call fill buf with next batch of matched path.
+ * Directory deeper than FAT32_PATH_MAX_DEPTH or with path longer than FAT32_PATH_MAX_LENGTH is not descended.
+ *
+ * @param request Find request & walk state
+ * @return Error code: 0 success - 2 root is not a directory - -1 invalid pattern / walk state or buf too small
+ */
+int8_t find_entries(struct FAT32FindRequest *request);
+
+#endif
@@ -58,6 +58,16 @@
 #define IRQ_PRIMARY_ATA 14
 #define IRQ_SECOND_ATA 15
 
+/* -- PIT (8253/8254) -- */
+#define PIT_CHANNEL0_DATA 0x40
+#define PIT_COMMAND 0x43
+#define PIT_CHANNEL0_SQUARE_WAVE 0x36
+#define PIT_BASE_FREQUENCY 1193182
+#define PIT_TIMER_FREQUENCY 100
+
+// EFLAGS IF bit, set when maskable hardware interrupt is enabled
+#define EFLAGS_INTERRUPT_FLAG (1 << 9)
+
 /**
  * CPURegister, store CPU registers values.
  *
@@ -150,6 +160,12 @@ void set_tss_kernel_current_stack(void);
 // Activate PIC mask for keyboard only
 void activate_keyboard_interrupt(void);
 
+// Program PIT channel 0 to PIT_TIMER_FREQUENCY and activate PIC mask for timer
+void activate_timer_interrupt(void);
+
+// Activate PIC mask for disk_irq() of selected disk backend (including slave cascade) and enable drive interrupt, call after initialize_disk()
+void activate_disk_interrupt(void);
+
 // I/O port wait, around 1-4 microsecond, for I/O synchronization purpose
 void io_wait(void);
 
@@ -15,6 +15,7 @@
 #define EXTENDED_SCANCODE_BYTE 0xE0
 
 #define MAX_ROWS 25
+#define MAX_COLS 80
 
 /**
  * line_lengths[MAX_ROWS]
@@ -70,6 +71,16 @@ void puts(const char *str, uint8_t size, uint8_t color);
 
 void puts_char(const char c, uint8_t color);
 
+/**
+ * Write text block, '\n' move to next row and line longer than MAX_COLS is wrapped.
+ * Cursor is only updated once after whole block is written.
+ *
+ * @param str   Text, not null-terminated
+ * @param size  Character count
+ * @param color Foreground color
+ */
+void puts_text(const char *str, uint32_t size, uint8_t color);
+
 void puts_newline(void);
 
 void reset_keyboard_state(void);
@@ -14,6 +14,15 @@
 // Maximum usable page frame. Default count: 128 / 4 = 32 page frame
 #define PAGE_FRAME_MAX_COUNT ((SYSTEM_MEMORY_MB << 20) / PAGE_FRAME_SIZE)
 
+// Kernel higher half base, kernel virtual address = physical address + KERNEL_VIRTUAL_BASE (first 4 MiB)
+#define KERNEL_VIRTUAL_BASE 0xC0000000
+
+// Kernel virtual address for block cache storage, one page frame right after kernel higher half mapping
+#define KERNEL_BLOCK_CACHE_VIRTUAL_ADDRESS ((void *)(KERNEL_VIRTUAL_BASE + PAGE_FRAME_SIZE))
+
+// Kernel virtual address for device MMIO window (ex: AHCI ABAR), one page frame after block cache
+#define KERNEL_MMIO_VIRTUAL_ADDRESS ((void *)(KERNEL_VIRTUAL_BASE + 2 * PAGE_FRAME_SIZE))
+
 // Operating system page directory, using page size PAGE_FRAME_SIZE (4 MiB)
 extern struct PageDirectory _paging_kernel_page_directory;
 
@@ -116,6 +125,27 @@ void update_page_directory_entry(
  */
 void flush_single_tlb(void *virtual_addr);
 
+/**
+ * Translate virtual address into physical address with page directory, used for DMA
+ *
+ * @param page_dir      Page directory to walk
+ * @param virtual_addr  Virtual address to translate
+ * @param physical_addr Output, physical address of virtual_addr
+ * @return              True if virtual_addr is mapped
+ */
+bool paging_virtual_to_physical(struct PageDirectory *page_dir, void *virtual_addr, uint32_t *physical_addr);
+
+/**
+ * Map page frame containing device register physical address into kernel virtual address,
+ * uncached (PCD & PWT). Frame is outside RAM so page frame map is not touched.
+ *
+ * @param page_dir      Page directory to update
+ * @param physical_addr Physical address of device register, ex: PCI memory BAR
+ * @param virtual_addr  Page frame aligned kernel virtual address, ex: KERNEL_MMIO_VIRTUAL_ADDRESS
+ * @return              Virtual address of physical_addr
+ */
+void *paging_map_kernel_mmio(struct PageDirectory *page_dir, uint32_t physical_addr, void *virtual_addr);
+
 /* --- Memory Management --- */
 /**
  * Check whether a certain amount of physical memory is available
@@ -134,6 +164,15 @@ bool paging_allocate_check(uint32_t amount);
  */
 bool paging_allocate_user_page_frame(struct PageDirectory *page_dir, void *virtual_addr);
 
+/**
+ * Allocate single kernel (supervisor only) page frame in page directory
+ *
+ * @param page_dir     Page directory to update
+ * @param virtual_addr Virtual address to be allocated
+ * @return             Will return true if success, false otherwise
+ */
+bool paging_allocate_kernel_page_frame(struct PageDirectory *page_dir, void *virtual_addr);
+
 /**
  * Deallocate single user page frame in page directory
  *
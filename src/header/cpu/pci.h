@@ -0,0 +1,125 @@
+#ifndef _PCI_H
+#define _PCI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* -- PCI configuration space mechanism #1 ports -- */
+#define PCI_CONFIG_ADDRESS 0xCF8
+#define PCI_CONFIG_DATA 0xCFC
+
+#define PCI_MAX_BUS 256
+#define PCI_MAX_SLOT 32
+#define PCI_MAX_FUNCTION 8
+
+/* -- PCI configuration space header offsets -- */
+#define PCI_OFFSET_VENDOR_ID 0x00
+#define PCI_OFFSET_COMMAND 0x04
+#define PCI_OFFSET_CLASS 0x08
+#define PCI_OFFSET_HEADER_TYPE 0x0C
+#define PCI_OFFSET_BAR0 0x10
+#define PCI_OFFSET_INTERRUPT_LINE 0x3C
+
+#define PCI_VENDOR_NONE 0xFFFF
+#define PCI_HEADER_TYPE_MULTIFUNCTION 0x80
+
+/* -- PCI command register bits -- */
+#define PCI_COMMAND_IO_SPACE 0x0001
+#define PCI_COMMAND_MEMORY_SPACE 0x0002
+#define PCI_COMMAND_BUS_MASTER 0x0004
+
+// BAR bit 0 set when BAR is I/O space
+#define PCI_BAR_IO_SPACE 0x1
+#define PCI_BAR_IO_MASK 0xFFFFFFFC
+#define PCI_BAR_MEMORY_MASK 0xFFFFFFF0
+
+/* -- PCI class code -- */
+#define PCI_CLASS_MASS_STORAGE 0x01
+#define PCI_SUBCLASS_IDE 0x01
+#define PCI_SUBCLASS_SATA 0x06
+// SATA programming interface for AHCI 1.0 controller
+#define PCI_PROG_IF_AHCI 0x01
+
+/**
+ * PCIDevice - Location and identity of a PCI function found while scanning
+ *
+ * @param bus            PCI bus number
+ * @param slot           Device number within bus
+ * @param function       Function number within device
+ * @param vendor_id      Vendor ID from configuration space
+ * @param device_id      Device ID from configuration space
+ * @param class_code     Base class code
+ * @param subclass       Subclass code
+ * @param prog_if        Programming interface byte
+ * @param interrupt_line Legacy PIC IRQ number routed by firmware
+ */
+struct PCIDevice
+{
+    uint8_t bus;
+    uint8_t slot;
+    uint8_t function;
+    uint16_t vendor_id;
+    uint16_t device_id;
+    uint8_t class_code;
+    uint8_t subclass;
+    uint8_t prog_if;
+    uint8_t interrupt_line;
+} __attribute__((packed));
+
+/**
+ * Read 32-bit value from PCI configuration space
+ *
+ * @param device PCI function location, only bus, slot, and function is used
+ * @param offset Register offset, must be 4-byte aligned
+ * @return       Register value
+ */
+uint32_t pci_config_read(const struct PCIDevice *device, uint8_t offset);
+
+/**
+ * Write 32-bit value into PCI configuration space
+ *
+ * @param device PCI function location, only bus, slot, and function is used
+ * @param offset Register offset, must be 4-byte aligned
+ * @param value  Value to write
+ */
+void pci_config_write(const struct PCIDevice *device, uint8_t offset, uint32_t value);
+
+/**
+ * Scan every bus for first function with matching class & subclass
+ *
+ * @param class_code Base class code to find
+ * @param subclass   Subclass code to find
+ * @param device     Output, filled when device found
+ * @return           True if device found
+ */
+bool pci_find_device_by_class(uint8_t class_code, uint8_t subclass, struct PCIDevice *device);
+
+/**
+ * Scan every bus for first function with matching vendor & device ID
+ *
+ * @param vendor_id Vendor ID to find
+ * @param device_id Device ID to find
+ * @param device    Output, filled when device found
+ * @return          True if device found
+ */
+bool pci_find_device_by_id(uint16_t vendor_id, uint16_t device_id, struct PCIDevice *device);
+
+/**
+ * Read base address register
+ *
+ * @param device    PCI function
+ * @param bar_index BAR index, 0 - 5
+ * @return          Raw BAR value, including I/O space bit
+ */
+uint32_t pci_read_bar(const struct PCIDevice *device, uint8_t bar_index);
+
+/**
+ * Set command register bits for the device, ex: PCI_COMMAND_BUS_MASTER for DMA capable device
+ *
+ * @param device PCI function
+ * @param bits   Command register bits to set
+ */
+void pci_enable_command(const struct PCIDevice *device, uint16_t bits);
+
+#endif
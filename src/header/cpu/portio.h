@@ -24,4 +24,8 @@ uint8_t in(uint16_t port);
 void out16(uint16_t port, uint16_t data);
 
 uint16_t in16(uint16_t port);
+
+void out32(uint16_t port, uint32_t data);
+
+uint32_t in32(uint16_t port);
 #endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+#ifndef _VIRTIO_BLK_H
+#define _VIRTIO_BLK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "disk.h"
+
+/* -- PCI identity, transitional virtio-blk with legacy I/O BAR0 -- */
+#define VIRTIO_VENDOR_ID 0x1AF4
+#define VIRTIO_BLK_DEVICE_ID_LEGACY 0x1001
+
+/* -- Legacy virtio PCI register (offset from BAR0 I/O port) -- */
+#define VIRTIO_REGISTER_DEVICE_FEATURES 0x00
+#define VIRTIO_REGISTER_GUEST_FEATURES 0x04
+#define VIRTIO_REGISTER_QUEUE_ADDRESS 0x08
+#define VIRTIO_REGISTER_QUEUE_SIZE 0x0C
+#define VIRTIO_REGISTER_QUEUE_SELECT 0x0E
+#define VIRTIO_REGISTER_QUEUE_NOTIFY 0x10
+#define VIRTIO_REGISTER_DEVICE_STATUS 0x12
+#define VIRTIO_REGISTER_ISR_STATUS 0x13
+// Device config without MSI-X: capacity (64-bit), size_max, seg_max
+#define VIRTIO_REGISTER_CONFIG 0x14
+#define VIRTIO_BLK_CONFIG_CAPACITY 0x00
+#define VIRTIO_BLK_CONFIG_SEG_MAX 0x0C
+
+#define VIRTIO_STATUS_ACKNOWLEDGE 0x01
+#define VIRTIO_STATUS_DRIVER 0x02
+#define VIRTIO_STATUS_DRIVER_OK 0x04
+#define VIRTIO_STATUS_FAILED 0x80
+
+#define VIRTIO_BLK_F_SEG_MAX (1u << 2)
+#define VIRTIO_BLK_F_FLUSH (1u << 9)
+
+/* -- Virtqueue -- */
+#define VIRTQ_DESC_F_NEXT 0x1
+#define VIRTQ_DESC_F_WRITE 0x2 // Buffer is written by device
+#define VIRTQ_USED_F_NO_NOTIFY 0x1
+// Legacy queue address register is page frame number of 4 KiB page, used ring is 4 KiB aligned
+#define VIRTQ_ALIGN 4096
+#define VIRTQ_ALIGN_UP(size) (((size) + VIRTQ_ALIGN - 1) & ~(VIRTQ_ALIGN - 1))
+// Largest queue size supported by driver (QEMU default), legacy device does not allow smaller size
+#define VIRTQ_MAX_SIZE 256
+// Descriptor table + available ring, then used ring on next 4 KiB page
+#define VIRTQ_MEMORY_SIZE(size) (VIRTQ_ALIGN_UP(16 * (size) + 6 + 2 * (size)) + VIRTQ_ALIGN_UP(6 + 8 * (size)))
+
+/* -- virtio-blk request -- */
+#define VIRTIO_BLK_T_IN 0
+#define VIRTIO_BLK_T_OUT 1
+#define VIRTIO_BLK_T_FLUSH 4
+#define VIRTIO_BLK_S_OK 0
+// Request header & status slot, request in flight before notify & wait
+#define VIRTIO_BLK_REQUEST_COUNT 32
+
+/**
+ * VirtqDescriptor - Entry of virtqueue descriptor table
+ *
+ * @param address Physical address of buffer
+ * @param length  Buffer size in byte
+ * @param flag    VIRTQ_DESC_F_NEXT if chained, VIRTQ_DESC_F_WRITE if device write into buffer
+ * @param next    Next descriptor index when VIRTQ_DESC_F_NEXT
+ */
+struct VirtqDescriptor
+{
+    uint64_t address;
+    uint32_t length;
+    uint16_t flag;
+    uint16_t next;
+} __attribute__((packed));
+
+/**
+ * VirtqAvailable - Available ring, written by driver
+ *
+ * @param flag  Ring flag, 0 for interrupt on used buffer
+ * @param index Next ring slot to be filled (free running)
+ * @param ring  Head descriptor of each chain
+ */
+struct VirtqAvailable
+{
+    uint16_t flag;
+    volatile uint16_t index;
+    uint16_t ring[];
+} __attribute__((packed));
+
+/**
+ * VirtqUsedElement - Entry of used ring
+ *
+ * @param id     Head descriptor of completed chain
+ * @param length Byte written by device
+ */
+struct VirtqUsedElement
+{
+    uint32_t id;
+    uint32_t length;
+} __attribute__((packed));
+
+/**
+ * VirtqUsed - Used ring, written by device
+ *
+ * @param flag  VIRTQ_USED_F_NO_NOTIFY when device does not need notify
+ * @param index Next ring slot to be filled by device (free running)
+ * @param ring  Completed chain
+ */
+struct VirtqUsed
+{
+    volatile uint16_t flag;
+    volatile uint16_t index;
+    struct VirtqUsedElement ring[];
+} __attribute__((packed));
+
+/**
+ * VirtioBlkRequestHeader - First descriptor of every virtio-blk request chain
+ *
+ * @param type     VIRTIO_BLK_T_IN, VIRTIO_BLK_T_OUT, or VIRTIO_BLK_T_FLUSH
+ * @param reserved Always 0
+ * @param sector   First 512-byte sector
+ */
+struct VirtioBlkRequestHeader
+{
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t sector;
+} __attribute__((packed));
+
+/**
+ * VirtioBlkState - State of virtio-blk device used as block backend
+ *
+ * @param io_base          Legacy register I/O port base (BAR0)
+ * @param queue_size       Descriptor count of request queue
+ * @param segment_max      Data descriptor limit per request (seg_max)
+ * @param flush            Device support VIRTIO_BLK_T_FLUSH
+ * @param descriptor_used  Descriptor allocated since last completion, allocated linearly
+ * @param request_used     Request slot allocated since last completion
+ * @param batch            Inside disk_batch_begin(), request is not notified & waited
+ * @param irq              PIC IRQ from PCI interrupt line
+ * @param irq_enabled      Interrupt completion path is active
+ * @param irq_received     Set by ISR
+ * @param block_count      Capacity in block
+ * @param descriptor       Descriptor table
+ * @param available        Available ring
+ * @param used             Used ring
+ */
+struct VirtioBlkState
+{
+    uint16_t io_base;
+    uint16_t queue_size;
+    uint16_t segment_max;
+    bool flush;
+    uint16_t descriptor_used;
+    uint8_t request_used;
+    bool batch;
+    uint8_t irq;
+    bool irq_enabled;
+    volatile bool irq_received;
+    uint32_t block_count;
+    struct VirtqDescriptor *descriptor;
+    struct VirtqAvailable *available;
+    struct VirtqUsed *used;
+} __attribute__((packed));
+
+/**
+ * Find legacy virtio-blk PCI device, negotiate feature, and set up request virtqueue.
+ * Each read / write become one descriptor chain (header, data segment, status), chains issued inside
+ * disk_batch_begin() share a single queue notify.
+ *
+ * @param device Output, filled with virtio-blk operations when device found
+ * @return       True if virtio-blk device found and ready
+ */
+bool virtio_blk_initialize(struct BlockDevice *device);
+
+#endif
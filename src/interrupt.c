@@ -3,6 +3,8 @@
 #include "header/cpu/keyboard.h"
 #include "header/cpu/gdt.h"
 #include "header/cpu/fat32.h"
+#include "header/cpu/block-cache.h"
+#include "header/cpu/block-queue.h"
 #include "header/text/framebuffer.h"
 
 void io_wait(void)
@@ -47,12 +49,21 @@ void main_interrupt_handler(struct InterruptFrame frame)
 {
     switch (frame.int_number)
     {
+    case PIC1_OFFSET + IRQ_TIMER:
+        block_cache_timer_tick();
+        pic_ack(IRQ_TIMER);
+        break;
     case PIC1_OFFSET + IRQ_KEYBOARD:
         keyboard_isr();
         break;
     case (0x30):
         syscall(frame);
         break;
+    default:
+        // IRQ disk mengikuti backend: IRQ14 untuk ATA, interrupt line PCI untuk AHCI & virtio-blk
+        if (disk_irq() != BLOCK_DEVICE_IRQ_NONE && frame.int_number == (uint32_t)(PIC1_OFFSET + disk_irq()))
+            disk_isr();
+        break;
     }
 }
 
@@ -61,6 +72,33 @@ void activate_keyboard_interrupt(void)
     out(PIC1_DATA, in(PIC1_DATA) & ~(1 << IRQ_KEYBOARD));
 }
 
+void activate_timer_interrupt(void)
+{
+    // PIT channel 0 mode 3 (square wave), divisor dikirim byte rendah lalu byte tinggi
+    uint16_t divisor = PIT_BASE_FREQUENCY / PIT_TIMER_FREQUENCY;
+    out(PIT_COMMAND, PIT_CHANNEL0_SQUARE_WAVE);
+    out(PIT_CHANNEL0_DATA, (uint8_t)divisor);
+    out(PIT_CHANNEL0_DATA, (uint8_t)(divisor >> 8));
+    out(PIC1_DATA, in(PIC1_DATA) & ~(1 << IRQ_TIMER));
+}
+
+void activate_disk_interrupt(void)
+{
+    uint8_t irq = disk_irq();
+    if (irq == BLOCK_DEVICE_IRQ_NONE)
+        return;
+
+    // IRQ 8 - 15 berada di PIC slave, sehingga cascade IRQ2 di PIC master juga harus dibuka
+    if (irq >= 8)
+    {
+        out(PIC1_DATA, in(PIC1_DATA) & ~(1 << IRQ_CASCADE));
+        out(PIC2_DATA, in(PIC2_DATA) & ~(1 << (irq - 8)));
+    }
+    else
+        out(PIC1_DATA, in(PIC1_DATA) & ~(1 << irq));
+    disk_irq_activate();
+}
+
 struct TSSEntry _interrupt_tss_entry = {
     .ss0 = GDT_KERNEL_DATA_SEGMENT_SELECTOR,
 };
@@ -76,6 +114,8 @@ void set_tss_kernel_current_stack(void)
 
 void syscall(struct InterruptFrame frame)
 {
+    // Write selama satu syscall (data, FAT, directory) diantrikan lalu dikirim terurut dan digabung
+    block_queue_plug();
     switch (frame.cpu.general.eax)
     {
     case 0:
@@ -118,5 +158,83 @@ void syscall(struct InterruptFrame frame)
     case 10:
         framebuffer_clear();
         break;
+    case 11:
+        block_cache_get_statistics((struct BlockCacheStatistics *)frame.cpu.general.ebx);
+        break;
+    case 12:
+        block_cache_sync();
+        break;
+    case 13:
+        *((uint32_t *)frame.cpu.general.ebx) = fat32_get_free_cluster_count();
+        break;
+    case 14:
+        *((int8_t *)frame.cpu.general.ecx) = preallocate(
+            *(struct FAT32DriverRequest *)frame.cpu.general.ebx);
+        break;
+    case 15:
+        *((int8_t *)frame.cpu.general.ecx) = read_directory_cluster(
+            *(struct FAT32DriverRequest *)frame.cpu.general.ebx,
+            frame.cpu.general.edx);
+        break;
+    case 16:
+        *((int8_t *)frame.cpu.general.ecx) = resolve_path(
+            *(struct FAT32PathRequest *)frame.cpu.general.ebx,
+            (struct FAT32PathEntry *)frame.cpu.general.edx);
+        break;
+    case 17:
+        *((int8_t *)frame.cpu.general.ecx) = read_range(
+            (struct FAT32RangeRequest *)frame.cpu.general.ebx);
+        break;
+    case 18:
+        *((int8_t *)frame.cpu.general.ecx) = write_range(
+            (struct FAT32RangeRequest *)frame.cpu.general.ebx);
+        break;
+    case 19:
+        *((int8_t *)frame.cpu.general.ecx) = open_file(
+            *(struct FAT32DriverRequest *)frame.cpu.general.ebx,
+            (uint8_t *)frame.cpu.general.edx);
+        break;
+    case 20:
+        *((int8_t *)frame.cpu.general.ecx) = close_file(frame.cpu.general.ebx);
+        break;
+    case 21:
+        *((int8_t *)frame.cpu.general.ecx) = read_file(
+            (struct FAT32FileRequest *)frame.cpu.general.ebx);
+        break;
+    case 22:
+        *((int8_t *)frame.cpu.general.ecx) = write_file(
+            (struct FAT32FileRequest *)frame.cpu.general.ebx);
+        break;
+    case 23:
+        *((int8_t *)frame.cpu.general.ecx) = seek_file(
+            (struct FAT32SeekRequest *)frame.cpu.general.ebx);
+        break;
+    case 24:
+        *((int8_t *)frame.cpu.general.ecx) = rename_entry(
+            *(struct FAT32DriverRequest *)frame.cpu.general.ebx,
+            *(struct FAT32DriverRequest *)frame.cpu.general.edx);
+        break;
+    case 25:
+        *((int8_t *)frame.cpu.general.ecx) = clone_entry(
+            *(struct FAT32DriverRequest *)frame.cpu.general.ebx,
+            *(struct FAT32DriverRequest *)frame.cpu.general.edx);
+        break;
+    case 26:
+        *((int8_t *)frame.cpu.general.ecx) = list_directory(
+            (struct FAT32ListRequest *)frame.cpu.general.ebx);
+        break;
+    case 27:
+        *((int8_t *)frame.cpu.general.ecx) = find_entries(
+            (struct FAT32FindRequest *)frame.cpu.general.ebx);
+        break;
+    case 28:
+        puts_text(
+            (char *)frame.cpu.general.ebx,
+            frame.cpu.general.ecx,
+            frame.cpu.general.edx);
+        break;
     }
+    block_queue_unplug();
+    // Flush periodik dijalankan di sini, bukan di timer ISR, agar tidak ada disk I/O reentrant
+    block_cache_flush_if_due();
 }
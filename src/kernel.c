@@ -6,6 +6,7 @@
 #include "header/cpu/keyboard.h"
 #include "header/cpu/fat32.h"
 #include "header/cpu/disk.h"
+#include "header/cpu/block-cache.h"
 #include "header/cpu/paging.h"
 #include <stdbool.h>
 
@@ -45,9 +46,21 @@ void kernel_setup(void)
     load_gdt(&_gdt_gdtr);
     pic_remap();
     initialize_idt();
+    activate_timer_interrupt();
     activate_keyboard_interrupt();
+    // Backend disk dipilih lebih dulu karena IRQ disk bergantung pada backend
+    initialize_disk();
+    activate_disk_interrupt();
     framebuffer_clear();
     framebuffer_set_cursor(0, 0);
+
+    // Block cache menggunakan satu page frame kernel, tanpa cache jika memory tidak cukup
+    // Write-back, dirty block di-flush oleh timer, threshold, atau syscall sync
+    if (paging_allocate_kernel_page_frame(&_paging_kernel_page_directory, KERNEL_BLOCK_CACHE_VIRTUAL_ADDRESS))
+    {
+        block_cache_initialize(KERNEL_BLOCK_CACHE_VIRTUAL_ADDRESS, PAGE_FRAME_SIZE);
+        block_cache_set_write_back(true);
+    }
     initialize_filesystem_fat32();
     gdt_install_tss();
     set_tss_register();
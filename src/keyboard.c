@@ -340,6 +340,24 @@ void puts_char(const char c, uint8_t color)
     framebuffer_set_cursor(keyboard_state.keyboard_row, keyboard_state.keyboard_col);
 }
 
+void puts_text(const char *str, uint32_t size, uint8_t color)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (str[i] != '\n')
+        {
+            framebuffer_write(keyboard_state.keyboard_row, keyboard_state.keyboard_col, str[i], color, 0);
+            keyboard_state.keyboard_col += 1;
+        }
+        if (str[i] == '\n' || keyboard_state.keyboard_col == MAX_COLS)
+        {
+            keyboard_state.keyboard_row += 1;
+            keyboard_state.keyboard_col = 0;
+        }
+    }
+    framebuffer_set_cursor(keyboard_state.keyboard_row, keyboard_state.keyboard_col);
+}
+
 void puts_newline(void)
 {
     keyboard_state.keyboard_row += 1;
@@ -44,6 +44,21 @@ void flush_single_tlb(void *virtual_addr) {
     asm volatile("invlpg (%0)" : /* <Empty> */ : "b"(virtual_addr): "memory");
 }
 
+bool paging_virtual_to_physical(struct PageDirectory *page_dir, void *virtual_addr, uint32_t *physical_addr) {
+    uint32_t page_index = ((uint32_t) virtual_addr >> 22) & 0x3FF;
+    if (!page_dir->table[page_index].flag.present_bit)
+        return false;
+
+    *physical_addr = ((uint32_t) page_dir->table[page_index].lower_address << 22) | ((uint32_t) virtual_addr & (PAGE_FRAME_SIZE - 1));
+    return true;
+}
+
+void *paging_map_kernel_mmio(struct PageDirectory *page_dir, uint32_t physical_addr, void *virtual_addr) {
+    // Register device tidak boleh di-cache, write harus langsung sampai ke device
+    struct PageDirectoryEntryFlag flag = {1, 1, 0, 1, 1, 0, 0, 1};
+    update_page_directory_entry(page_dir, (void *)(physical_addr & ~(PAGE_FRAME_SIZE - 1)), virtual_addr, flag);
+    return (uint8_t *)virtual_addr + (physical_addr & (PAGE_FRAME_SIZE - 1));
+}
 
 /* --- Memory Management --- */
 bool paging_allocate_check(uint32_t amount) {
@@ -52,8 +67,8 @@ bool paging_allocate_check(uint32_t amount) {
 }
 
 
-bool paging_allocate_user_page_frame(struct PageDirectory *page_dir, void *virtual_addr) {
-    // Find a free physical frame
+// Mengalokasikan page frame kosong pertama dengan flag yang diberikan
+static bool paging_allocate_page_frame(struct PageDirectory *page_dir, void *virtual_addr, struct PageDirectoryEntryFlag flag) {
     // Find a free page frame
     for (uint32_t i = 0; i < PAGE_FRAME_MAX_COUNT; i++)
     {
@@ -64,7 +79,6 @@ bool paging_allocate_user_page_frame(struct PageDirectory *page_dir, void *virtu
             page_manager_state.free_page_frame_count--;
 
             // Update the page directory
-            struct PageDirectoryEntryFlag flag = {1, 1, 1, 0, 0, 0, 0, 1};
             update_page_directory_entry(page_dir, (void *)(i * PAGE_FRAME_SIZE), virtual_addr, flag);
 
             // Invalidate the TLB entry for the virtual address
@@ -78,6 +92,17 @@ bool paging_allocate_user_page_frame(struct PageDirectory *page_dir, void *virtu
     return false;
 }
 
+bool paging_allocate_user_page_frame(struct PageDirectory *page_dir, void *virtual_addr) {
+    struct PageDirectoryEntryFlag flag = {1, 1, 1, 0, 0, 0, 0, 1};
+    return paging_allocate_page_frame(page_dir, virtual_addr, flag);
+}
+
+bool paging_allocate_kernel_page_frame(struct PageDirectory *page_dir, void *virtual_addr) {
+    // Tanpa user_supervisor_bit, hanya bisa diakses ring 0
+    struct PageDirectoryEntryFlag flag = {1, 1, 0, 0, 0, 0, 0, 1};
+    return paging_allocate_page_frame(page_dir, virtual_addr, flag);
+}
+
 bool paging_free_user_page_frame(struct PageDirectory *page_dir, void *virtual_addr) {
    uint32_t index = (uint32_t)virtual_addr / PAGE_FRAME_SIZE;
 
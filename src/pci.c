@@ -0,0 +1,102 @@
+#include "header/cpu/pci.h"
+#include "header/cpu/portio.h"
+
+// Membentuk alamat konfigurasi PCI (mechanism #1)
+static uint32_t pci_config_address(const struct PCIDevice *device, uint8_t offset)
+{
+    return (1u << 31) |
+           ((uint32_t)device->bus << 16) |
+           ((uint32_t)(device->slot & 0x1F) << 11) |
+           ((uint32_t)(device->function & 0x7) << 8) |
+           (offset & 0xFC);
+}
+
+uint32_t pci_config_read(const struct PCIDevice *device, uint8_t offset)
+{
+    out32(PCI_CONFIG_ADDRESS, pci_config_address(device, offset));
+    return in32(PCI_CONFIG_DATA);
+}
+
+void pci_config_write(const struct PCIDevice *device, uint8_t offset, uint32_t value)
+{
+    out32(PCI_CONFIG_ADDRESS, pci_config_address(device, offset));
+    out32(PCI_CONFIG_DATA, value);
+}
+
+// Mengisi identitas device dari configuration space, false jika slot kosong
+static bool pci_probe_function(struct PCIDevice *device)
+{
+    uint32_t id = pci_config_read(device, PCI_OFFSET_VENDOR_ID);
+    if ((id & 0xFFFF) == PCI_VENDOR_NONE)
+        return false;
+
+    uint32_t class = pci_config_read(device, PCI_OFFSET_CLASS);
+    device->vendor_id = id & 0xFFFF;
+    device->device_id = id >> 16;
+    device->class_code = class >> 24;
+    device->subclass = (class >> 16) & 0xFF;
+    device->prog_if = (class >> 8) & 0xFF;
+    device->interrupt_line = pci_config_read(device, PCI_OFFSET_INTERRUPT_LINE) & 0xFF;
+    return true;
+}
+
+// Mencari function pertama yang cocok dengan filter: vendor & device ID jika match_id, class & subclass jika tidak
+static bool pci_find_device(const struct PCIDevice *filter, bool match_id, struct PCIDevice *device)
+{
+    struct PCIDevice candidate = {0};
+    for (uint32_t bus = 0; bus < PCI_MAX_BUS; bus++)
+    {
+        for (uint8_t slot = 0; slot < PCI_MAX_SLOT; slot++)
+        {
+            candidate.bus = bus;
+            candidate.slot = slot;
+            candidate.function = 0;
+            if (!pci_probe_function(&candidate))
+                continue;
+
+            // Hanya device multifunction yang memiliki function 1 - 7
+            uint8_t function_count = 1;
+            if ((pci_config_read(&candidate, PCI_OFFSET_HEADER_TYPE) >> 16) & PCI_HEADER_TYPE_MULTIFUNCTION)
+                function_count = PCI_MAX_FUNCTION;
+
+            for (uint8_t function = 0; function < function_count; function++)
+            {
+                candidate.function = function;
+                if (!pci_probe_function(&candidate))
+                    continue;
+                bool match = match_id ? candidate.vendor_id == filter->vendor_id && candidate.device_id == filter->device_id
+                                      : candidate.class_code == filter->class_code && candidate.subclass == filter->subclass;
+                if (match)
+                {
+                    *device = candidate;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool pci_find_device_by_class(uint8_t class_code, uint8_t subclass, struct PCIDevice *device)
+{
+    struct PCIDevice filter = {.class_code = class_code, .subclass = subclass};
+    return pci_find_device(&filter, false, device);
+}
+
+bool pci_find_device_by_id(uint16_t vendor_id, uint16_t device_id, struct PCIDevice *device)
+{
+    struct PCIDevice filter = {.vendor_id = vendor_id, .device_id = device_id};
+    return pci_find_device(&filter, true, device);
+}
+
+uint32_t pci_read_bar(const struct PCIDevice *device, uint8_t bar_index)
+{
+    return pci_config_read(device, PCI_OFFSET_BAR0 + 4 * bar_index);
+}
+
+void pci_enable_command(const struct PCIDevice *device, uint16_t bits)
+{
+    uint32_t command = pci_config_read(device, PCI_OFFSET_COMMAND);
+    // Bagian atas register adalah status, tulis 0 agar bit RW1C tidak ter-clear
+    pci_config_write(device, PCI_OFFSET_COMMAND, (command & 0xFFFF) | bits);
+}
@@ -14,8 +14,29 @@
 #define KEYBOARD_UP_ROW 8
 #define KEYBOARD_RESET 9
 #define CLEAR_SCREEN 10
+#define BLOCK_CACHE_STATISTICS 11
+#define SYNC 12
+#define READ_DIR_CLUSTER 15
+#define RESOLVE_PATH 16
+#define READ_RANGE 17
+#define OPEN_FILE 19
+#define CLOSE_FILE 20
+#define READ_FILE 21
+#define WRITE_FILE 22
+#define SEEK_FILE 23
+#define RENAME 24
+#define CLONE 25
+#define LIST_DIR 26
+#define FIND 27
+#define PUTS_TEXT 28
+
+// Record yang diambil per syscall LIST_DIR
+#define LIST_BATCH 32
+// Ukuran potongan cat / cp, memori yang dipakai tetap berapapun ukuran file
+#define STREAM_CHUNK_SIZE 4096
+
+static char stream_buffer[STREAM_CHUNK_SIZE];
 
-#define STACK_SIZE 100
 struct DirectoryState
 {
     char name[8];
@@ -24,14 +45,11 @@ struct DirectoryState
 };
 
 static struct DirectoryState current_directory = {
-    .name = "root",
+    .name = "ROOT",
     .cluster_number = ROOT_CLUSTER_NUMBER,
     .parent_cluster_number = ROOT_CLUSTER_NUMBER,
 };
 
-static struct DirectoryState directory_stack[STACK_SIZE];
-static int top = -1;
-
 void syscall(uint32_t eax, uint32_t ebx, uint32_t ecx, uint32_t edx)
 {
     __asm__ volatile("mov %0, %%ebx" : /* <Empty> */ : "r"(ebx));
@@ -43,222 +61,264 @@ void syscall(uint32_t eax, uint32_t ebx, uint32_t ecx, uint32_t edx)
     __asm__ volatile("int $0x30");
 }
 
-void push_directory(struct DirectoryState directory)
+// Menerjemahkan path relatif terhadap current directory dengan satu syscall
+int8_t resolve(const char *path, struct FAT32PathEntry *entry)
 {
-    if (top >= STACK_SIZE - 1)
-    {
-        syscall(PUTS, (uint32_t) "Stack Overflow", 14, 0xC);
-        return;
-    }
-    directory_stack[++top] = directory;
+    struct FAT32PathRequest request = {
+        .path = path,
+        .start_cluster_number = current_directory.cluster_number,
+    };
+    int8_t flag = 2;
+    syscall(RESOLVE_PATH, (uint32_t)&request, (uint32_t)&flag, (uint32_t)entry);
+    return flag;
 }
 
-struct DirectoryState pop_directory()
+// Menentukan directory dan nama tujuan cp / mv, tujuan berupa directory berarti nama sumber dipertahankan
+bool resolve_destination(char *destination, const struct FAT32PathEntry *source, uint32_t *parent_cluster, char *name)
 {
-    if (top < 0)
+    struct FAT32PathEntry entry;
+    if (resolve(destination, &entry) == 0)
     {
-        syscall(PUTS, (uint32_t) "Stack Underflow", 15, 0xC);
-        struct DirectoryState empty_directory = {.cluster_number = 0};
-        return empty_directory;
+        if (entry.attribute == ATTR_SUBDIRECTORY)
+        {
+            *parent_cluster = entry.cluster_number;
+            memcpy(name, source->name, 8);
+        }
+        else
+        {
+            *parent_cluster = entry.parent_cluster_number;
+            memcpy(name, entry.name, 8);
+        }
+        return true;
     }
-    return directory_stack[top--];
-}
-
-void mv(char *source, char *destination)
-{
-    struct FAT32DirectoryTable buf_dir;
-    struct FAT32DriverRequest request_dir = {
-        .buf = &buf_dir,
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = 0,
-    };
 
-    memcpy(request_dir.name, current_directory.name, sizeof(request_dir.name));
-    syscall(READ_DIR, (uint32_t)&request_dir, 0, 0);
-    uint32_t filesize = 0;
-
-    for (int i = 2; i < 64; i++)
+    // Tujuan belum ada, komponen terakhir menjadi nama file baru
+    char *last = destination;
+    for (char *c = destination; *c != '\0'; c++)
+        if (*c == '/')
+            last = c + 1;
+    memset(name, 0, 8);
+    for (int i = 0; i < 8 && last[i] != '\0'; i++)
+        name[i] = last[i];
+    if (last == destination)
     {
-        if (buf_dir.table[i].user_attribute == UATTR_NOT_EMPTY)
-        {
-
-            if (strcmp(buf_dir.table[i].name, source))
-            {
-                filesize = buf_dir.table[i].filesize;
-            }
-        }
+        *parent_cluster = current_directory.cluster_number;
+        return true;
     }
 
-    struct ClusterBuffer buf;
-    struct FAT32DriverRequest request = {
-        .buf = &buf,
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = 0x100000,
-    };
+    char separator = last[-1];
+    last[-1] = '\0';
+    int8_t flag = resolve(last - 1 == destination ? "/" : destination, &entry);
+    last[-1] = separator;
+    if (flag != 0 || entry.attribute != ATTR_SUBDIRECTORY)
+        return false;
+    *parent_cluster = entry.cluster_number;
+    return true;
+}
 
-    memcpy(request.name, source, 8);
+// Menyiapkan request sumber dan tujuan cp / mv dari path, file tujuan yang sudah ada ditimpa.
+// False jika sumber / directory tujuan tidak ditemukan atau sumber sama dengan tujuan
+bool prepare_transfer(char *source, char *destination, struct FAT32DriverRequest *request, struct FAT32DriverRequest *request2)
+{
+    struct FAT32PathEntry source_entry;
+    if (resolve(source, &source_entry) != 0)
+    {
+        syscall(PUTS, (uint32_t) "File not found", 14, 0xC);
+        return false;
+    }
 
-    syscall(READ, (uint32_t)&request, 0, 0);
+    memset(request, 0, sizeof(struct FAT32DriverRequest));
+    request->parent_cluster_number = source_entry.parent_cluster_number;
+    memcpy(request->name, source_entry.name, 8);
+    memcpy(request->ext, source_entry.ext, 3);
 
-    struct FAT32DriverRequest request2 = {
-        .buf = &buf,
-        .ext = "\0\0\0",
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = filesize,
-    };
+    memset(request2, 0, sizeof(struct FAT32DriverRequest));
+    uint32_t parent_cluster;
+    if (!resolve_destination(destination, &source_entry, &parent_cluster, request2->name))
+    {
+        syscall(PUTS, (uint32_t) "Directory not found", 19, 0xC);
+        return false;
+    }
+    request2->parent_cluster_number = parent_cluster;
+    memcpy(request2->ext, source_entry.ext, 3);
+    if (parent_cluster == source_entry.parent_cluster_number && !memcmp(request2->name, source_entry.name, 8))
+        return false;
+
+    // File tujuan yang sudah ada ditimpa, folder tujuan tidak dihapus
+    struct FAT32RangeRequest probe = {.request = *request2};
+    int8_t flag = 2;
+    syscall(READ_RANGE, (uint32_t)&probe, (uint32_t)&flag, 0);
+    if (flag == 0)
+        syscall(DELETE, (uint32_t)request2, 0, 0);
+    return true;
+}
 
-    memcpy(request2.name, destination, sizeof(request2.name));
+void mv(char *source, char *destination)
+{
+    struct FAT32DriverRequest request;
+    struct FAT32DriverRequest request2;
+    if (!prepare_transfer(source, destination, &request, &request2))
+        return;
 
-    uint32_t flag = 2;
-    syscall(READ, (uint32_t)&request2, flag, 0);
-    if (flag == 0)
-        syscall(DELETE, (uint32_t)&request2, 0, 0);
-    syscall(WRITE, (uint32_t)&request2, 0, 0);
-    syscall(DELETE, (uint32_t)&request, 0, 0);
+    // Hanya directory entry yang dipindahkan, data file tidak disalin
+    int8_t flag = 0;
+    syscall(RENAME, (uint32_t)&request, (uint32_t)&flag, (uint32_t)&request2);
+    if (flag != 0)
+        syscall(PUTS, (uint32_t) "Cannot move", 11, 0xC);
 }
 
-void cp(char *source, char *destination)
+// Menyalin isi file per potongan STREAM_CHUNK_SIZE, potongan pertama membuat file tujuan
+int8_t copy_stream(struct FAT32DriverRequest *request, struct FAT32DriverRequest *request2)
 {
-    struct FAT32DirectoryTable buf_dir;
-    struct FAT32DriverRequest request_dir = {
-        .buf = &buf_dir,
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = 0,
+    uint8_t source_descriptor;
+    int8_t flag = 2;
+    int8_t close_flag;
+    syscall(OPEN_FILE, (uint32_t)request, (uint32_t)&flag, (uint32_t)&source_descriptor);
+    if (flag != 0)
+        return flag;
+
+    struct FAT32FileRequest read_request = {
+        .descriptor = source_descriptor,
+        .buf = stream_buffer,
+        .size = STREAM_CHUNK_SIZE,
     };
+    syscall(READ_FILE, (uint32_t)&read_request, (uint32_t)&flag, 0);
+    if (flag == 0 && read_request.transferred_size == 0)
+        flag = -1; // Error: file kosong tidak dapat dibuat dengan WRITE
+    if (flag == 0)
+    {
+        request2->buf = stream_buffer;
+        request2->buffer_size = read_request.transferred_size;
+        syscall(WRITE, (uint32_t)request2, (uint32_t)&flag, 0);
+    }
 
-    memcpy(request_dir.name, current_directory.name, sizeof(request_dir.name));
-    syscall(READ_DIR, (uint32_t)&request_dir, 0, 0);
-    uint32_t filesize = 0;
-
-    for (int i = 2; i < 64; i++)
+    uint8_t destination_descriptor;
+    if (flag == 0)
+        syscall(OPEN_FILE, (uint32_t)request2, (uint32_t)&flag, (uint32_t)&destination_descriptor);
+    if (flag == 0)
     {
-        if (buf_dir.table[i].user_attribute == UATTR_NOT_EMPTY)
+        struct FAT32SeekRequest seek_request = {
+            .descriptor = destination_descriptor,
+            .offset = 0,
+            .whence = FAT32_SEEK_END,
+        };
+        syscall(SEEK_FILE, (uint32_t)&seek_request, (uint32_t)&flag, 0);
+
+        struct FAT32FileRequest write_request = {
+            .descriptor = destination_descriptor,
+            .buf = stream_buffer,
+        };
+        while (flag == 0 && read_request.transferred_size == STREAM_CHUNK_SIZE)
         {
-
-            if (strcmp(buf_dir.table[i].name, source))
-            {
-                filesize = buf_dir.table[i].filesize;
-            }
+            syscall(READ_FILE, (uint32_t)&read_request, (uint32_t)&flag, 0);
+            write_request.size = read_request.transferred_size;
+            if (flag == 0 && write_request.size > 0)
+                syscall(WRITE_FILE, (uint32_t)&write_request, (uint32_t)&flag, 0);
         }
+        syscall(CLOSE_FILE, destination_descriptor, (uint32_t)&close_flag, 0);
     }
+    syscall(CLOSE_FILE, source_descriptor, (uint32_t)&close_flag, 0);
+    return flag;
+}
 
-    struct ClusterBuffer buf;
-    struct FAT32DriverRequest request = {
-        .buf = &buf,
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = 0x100000,
-    };
-
-    memcpy(request.name, source, 8);
-
-    syscall(READ, (uint32_t)&request, 0, 0);
-
-    struct FAT32DriverRequest request2 = {
-        .buf = &buf,
-        .ext = "\0\0\0",
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = filesize,
-    };
-
-    memcpy(request2.name, destination, sizeof(request2.name));
+void cp(char *source, char *destination)
+{
+    struct FAT32DriverRequest request;
+    struct FAT32DriverRequest request2;
+    if (!prepare_transfer(source, destination, &request, &request2))
+        return;
 
-    uint32_t flag = 2;
-    syscall(READ, (uint32_t)&request2, flag, 0);
-    if (flag == 0)
-        syscall(DELETE, (uint32_t)&request2, 0, 0);
-    syscall(WRITE, (uint32_t)&request2, 0, 0);
+    // Clone berbagi cluster dengan sumber, cluster baru disalin saat salah satu file diubah.
+    // Jika clone tidak bisa (counter penuh / tabel refcount tidak muat), isi file disalin bertahap
+    int8_t flag = 0;
+    syscall(CLONE, (uint32_t)&request, (uint32_t)&flag, (uint32_t)&request2);
+    if (flag == -1)
+        flag = copy_stream(&request, &request2);
+    if (flag != 0)
+        syscall(PUTS, (uint32_t) "Cannot copy", 11, 0xC);
 }
 
-void find(char *name, uint32_t cluster_number, char *curent_dir, uint32_t next_cluster)
+void find(char *name)
 {
-    struct FAT32DirectoryTable buf;
-    struct FAT32DriverRequest request = {.buf = &buf,
-                                         .parent_cluster_number = cluster_number,
-                                         .buffer_size = sizeof(struct FAT32DirectoryTable)};
-    memcpy(request.name, curent_dir, sizeof(request.name));
-
-    syscall(1, (uint32_t)&request, 0, 0);
-    for (int i = 2; i < 64; i++)
+    // Kernel menelusuri seluruh tree, path yang cocok dikirim bertahap per buffer
+    static struct FAT32FindRequest request;
+    char paths[1024];
+    memset(&request, 0, sizeof(request));
+    request.root_cluster = ROOT_CLUSTER_NUMBER;
+    request.buf = paths;
+    request.buffer_size = sizeof(paths);
+    for (uint8_t i = 0; i < FAT32_FIND_PATTERN_LENGTH - 1 && name[i] != '\0'; i++)
+        request.pattern[i] = name[i];
+
+    int8_t flag = 0;
+    while (!request.done)
     {
-        if (buf.table[i].user_attribute == UATTR_NOT_EMPTY)
+        syscall(FIND, (uint32_t)&request, (uint32_t)&flag, 0);
+        if (flag != 0)
+            return;
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < request.match_count; i++)
         {
-            if (strcmp(buf.table[i].name, name))
-            {
-                syscall(6, (uint32_t)buf.table[i].name, 8, 0xF);
-                return;
-            }
-            else if (buf.table[i].attribute == ATTR_SUBDIRECTORY)
-            {
-                find(name, next_cluster, buf.table[i].name, buf.table[i].cluster_low | (buf.table[i].cluster_high << 16));
-            }
+            uint32_t length = 0;
+            while (paths[offset + length] != '\0')
+                length++;
+            syscall(PUTS, (uint32_t)(paths + offset), length, 0xF);
+            syscall(PUTS_CHAR, (uint32_t)' ', 0xF, 0);
+            offset += length + 1;
         }
     }
 }
 
 void cd(char *name)
 {
-    if (strcmp(name, ".."))
+    // Seluruh komponen path (termasuk "..") diselesaikan kernel dalam satu syscall
+    struct FAT32PathEntry entry;
+    if (resolve(name, &entry) != 0 || entry.attribute != ATTR_SUBDIRECTORY)
     {
-        if (top < 0)
-            return;
-        current_directory = pop_directory();
+        syscall(PUTS, (uint32_t) "Directory not found", 19, 0xC);
         return;
     }
-    struct FAT32DirectoryTable buf;
-    struct FAT32DriverRequest request = {.buf = &buf,
-                                         .parent_cluster_number = current_directory.parent_cluster_number,
-                                         .buffer_size = sizeof(struct FAT32DirectoryTable)};
-    memcpy(request.name, current_directory.name, sizeof(current_directory.name));
-
-    syscall(READ_DIR, (uint32_t)&request, 0, 0);
-    for (int i = 2; i < 64; i++)
-    {
-        if (buf.table[i].user_attribute == UATTR_NOT_EMPTY)
-        {
-            if (buf.table[i].attribute == ATTR_SUBDIRECTORY)
-            {
-                if (strcmp(buf.table[i].name, name))
-                {
-                    push_directory(current_directory);
-                    current_directory.parent_cluster_number = current_directory.cluster_number;
-                    current_directory.cluster_number = buf.table[i].cluster_low | (buf.table[i].cluster_high << 16);
-                    memcpy(current_directory.name, name, sizeof(current_directory.name));
-                    return;
-                }
-            }
-        }
-    }
-    syscall(PUTS, (uint32_t) "Directory not found", 19, 0xC);
+    memcpy(current_directory.name, entry.name, sizeof(current_directory.name));
+    current_directory.cluster_number = entry.cluster_number;
+    current_directory.parent_cluster_number = entry.parent_cluster_number;
 }
 
 void cat(char *name)
 {
-    struct ClusterBuffer buf;
+    struct FAT32PathEntry entry;
+    if (resolve(name, &entry) != 0 || entry.attribute == ATTR_SUBDIRECTORY)
+    {
+        syscall(PUTS, (uint32_t) "File not found", 14, 0xC);
+        syscall(KEYBOARD_UP_ROW, 0, 0, 0);
+        return;
+    }
+
     struct FAT32DriverRequest request = {
-        .buf = &buf,
-        .parent_cluster_number = current_directory.parent_cluster_number,
-        .buffer_size = 0x100000,
+        .parent_cluster_number = entry.parent_cluster_number,
     };
+    memcpy(request.name, entry.name, 8);
+    memcpy(request.ext, entry.ext, 3);
 
-    memcpy(request.name, name, sizeof(request.name));
+    uint8_t descriptor;
+    int8_t flag = 2;
+    syscall(OPEN_FILE, (uint32_t)&request, (uint32_t)&flag, (uint32_t)&descriptor);
+    if (flag != 0)
+        return;
 
-    int8_t flag = 4;
-    syscall(READ, (uint32_t)&request, (uint32_t)&flag, 0);
-    if (flag == 0)
+    // Setiap potongan dicetak dengan satu syscall, buffer tetap berapapun ukuran file
+    struct FAT32FileRequest read_request = {
+        .descriptor = descriptor,
+        .buf = stream_buffer,
+        .size = STREAM_CHUNK_SIZE,
+    };
+    do
     {
-        int i = 0;
-        while (buf.buf[i] != '\0')
-        {
-            if (buf.buf[i] == '\n')
-            {
-                syscall(KEYBOARD_UP_ROW, 0, 0, 0);
-            }
-            else
-                syscall(PUTS_CHAR, (uint32_t)buf.buf[i], 0xF, 0);
-            i++;
-        }
-        syscall(KEYBOARD_UP_ROW, 0, 0, 0);
-    }
+        syscall(READ_FILE, (uint32_t)&read_request, (uint32_t)&flag, 0);
+        if (flag == 0)
+            syscall(PUTS_TEXT, (uint32_t)stream_buffer, read_request.transferred_size, 0xF);
+    } while (flag == 0 && read_request.transferred_size == STREAM_CHUNK_SIZE);
+    syscall(CLOSE_FILE, descriptor, (uint32_t)&flag, 0);
+    syscall(KEYBOARD_UP_ROW, 0, 0, 0);
 }
 
 void rm(char *name)
@@ -289,20 +349,25 @@ void mkdir(char *name)
 
 void ls()
 {
-    struct FAT32DirectoryTable buf;
-    struct FAT32DriverRequest request = {.buf = &buf,
-                                         .parent_cluster_number = current_directory.parent_cluster_number,
-                                         .buffer_size = sizeof(struct FAT32DirectoryTable)};
-    memcpy(request.name, current_directory.name, sizeof(request.name));
-
-    syscall(READ_DIR, (uint32_t)&request, 0, 0);
-    for (int i = 2; i < 64; i++)
+    // Hanya entry yang terisi dikirim kernel, directory besar dibaca bertahap dengan cookie
+    struct FAT32DirectoryRecord records[LIST_BATCH];
+    struct FAT32ListRequest request = {
+        .directory_cluster = current_directory.cluster_number,
+        .buf = records,
+        .record_capacity = LIST_BATCH,
+        .cookie = 0,
+    };
+    int8_t flag = 0;
+    while (request.cookie != FAT32_LIST_COOKIE_END)
     {
-        if (buf.table[i].user_attribute == UATTR_NOT_EMPTY)
+        syscall(LIST_DIR, (uint32_t)&request, (uint32_t)&flag, 0);
+        if (flag != 0)
+            return;
+        for (uint32_t i = 0; i < request.record_count; i++)
         {
-            if (buf.table[i].attribute == ATTR_SUBDIRECTORY)
+            if (records[i].attribute == ATTR_SUBDIRECTORY)
                 syscall(PUTS_CHAR, (uint32_t)'/', 0xF, 0);
-            syscall(PUTS, (uint32_t)buf.table[i].name, 8, 0xF);
+            syscall(PUTS, (uint32_t)records[i].name, 8, 0xF);
             syscall(PUTS_CHAR, (uint32_t)' ', 0xF, 0);
         }
     }
@@ -326,6 +391,11 @@ void handle_command(char *input)
         syscall(CLEAR_SCREEN, 0, 0, 0);
         syscall(KEYBOARD_RESET, 0, 0, 0);
     }
+    else if (strcmp(temp, "sync"))
+    {
+        syscall(SYNC, 0, 0, 0);
+        syscall(KEYBOARD_UP_ROW, 0, 0, 0);
+    }
     else if (strcmp(temp, "ls"))
     {
         syscall(KEYBOARD_UP_ROW, 0, 0, 0);
@@ -360,7 +430,7 @@ void handle_command(char *input)
     {
         syscall(KEYBOARD_UP_ROW, 0, 0, 0);
         char *test = get_string(temp, 1);
-        find(test, ROOT_CLUSTER_NUMBER, current_directory.name, ROOT_CLUSTER_NUMBER);
+        find(test);
         syscall(KEYBOARD_UP_ROW, 0, 0, 0);
     }
     else if (strcmp(input, "cp"))
@@ -392,7 +462,8 @@ void handle_command(char *input)
 
 int main(void)
 {
-    memcpy(current_directory.name, "root", 4);
+    // Nama root diambil dari entry-0 root directory
+    cd("/");
     show_home();
     syscall(KEYBOARD_ACTIVATE, 0, 0, 0);
     char input[256];
@@ -0,0 +1,317 @@
+#include "header/cpu/virtio-blk.h"
+#include "header/cpu/interrupt.h"
+#include "header/cpu/paging.h"
+#include "header/cpu/pci.h"
+#include "header/cpu/portio.h"
+#include "header/stdlib/string.h"
+
+static struct VirtioBlkState virtio_blk_state = {
+    .io_base = 0,
+    .queue_size = 0,
+    .descriptor_used = 0,
+    .request_used = 0,
+    .batch = false,
+    .irq = BLOCK_DEVICE_IRQ_NONE,
+    .irq_enabled = false,
+    .irq_received = false,
+    .block_count = 0,
+};
+
+// Virtqueue, header, dan status request berada di image kernel, physical = virtual - KERNEL_VIRTUAL_BASE
+static uint8_t virtio_blk_queue[VIRTQ_MEMORY_SIZE(VIRTQ_MAX_SIZE)] __attribute__((aligned(VIRTQ_ALIGN)));
+static struct VirtioBlkRequestHeader virtio_blk_header[VIRTIO_BLK_REQUEST_COUNT];
+static volatile uint8_t virtio_blk_status[VIRTIO_BLK_REQUEST_COUNT];
+
+// Physical address memory di image kernel
+static uint32_t virtio_blk_physical(const volatile void *ptr)
+{
+    return (uint32_t)ptr - KERNEL_VIRTUAL_BASE;
+}
+
+// Mengisi descriptor berikutnya, descriptor sebelumnya di-chain ke descriptor ini
+static void virtio_blk_descriptor_add(uint32_t physical_addr, uint32_t length, uint16_t flag)
+{
+    uint16_t index = virtio_blk_state.descriptor_used++;
+    virtio_blk_state.descriptor[index].address = physical_addr;
+    virtio_blk_state.descriptor[index].length = length;
+    virtio_blk_state.descriptor[index].flag = flag;
+    virtio_blk_state.descriptor[index].next = index + 1;
+}
+
+// Menunggu device memproses seluruh chain di available ring, CPU di-HLT selama menunggu interrupt
+static void virtio_blk_wait(void)
+{
+    uint32_t eflags;
+    __asm__ volatile("pushf; pop %0; cli" : "=r"(eflags) : /* <Empty> */ : "memory");
+    while (virtio_blk_state.used->index != virtio_blk_state.available->index)
+    {
+        if (virtio_blk_state.irq_enabled && !virtio_blk_state.irq_received)
+            // sti baru berlaku setelah instruksi berikutnya, sehingga tidak ada IRQ yang terlewat sebelum hlt
+            __asm__ volatile("sti; hlt; cli" ::: "memory");
+        virtio_blk_state.irq_received = false;
+    }
+    if (eflags & EFLAGS_INTERRUPT_FLAG)
+        __asm__ volatile("sti");
+}
+
+// Satu notify untuk seluruh chain yang belum dikirim, lalu menunggu semuanya selesai dan mengosongkan descriptor
+static void virtio_blk_complete(void)
+{
+    if (virtio_blk_state.request_used == 0)
+        return;
+
+    // Ring harus sudah terlihat device sebelum notify, satu notify = satu VM exit
+    __asm__ volatile("" ::: "memory");
+    if (!(virtio_blk_state.used->flag & VIRTQ_USED_F_NO_NOTIFY))
+        out16(virtio_blk_state.io_base + VIRTIO_REGISTER_QUEUE_NOTIFY, 0);
+    virtio_blk_wait();
+
+    virtio_blk_state.descriptor_used = 0;
+    virtio_blk_state.request_used = 0;
+}
+
+// Memulai chain request baru (descriptor header), chain lama diselesaikan dulu jika slot atau descriptor tidak cukup
+static uint16_t virtio_blk_request_begin(uint32_t type, uint32_t logical_block_address)
+{
+    // Minimal header, satu descriptor data, dan status
+    if (virtio_blk_state.request_used == VIRTIO_BLK_REQUEST_COUNT ||
+        virtio_blk_state.descriptor_used + 3 > virtio_blk_state.queue_size)
+        virtio_blk_complete();
+
+    uint8_t request = virtio_blk_state.request_used;
+    virtio_blk_header[request].type = type;
+    virtio_blk_header[request].reserved = 0;
+    virtio_blk_header[request].sector = logical_block_address;
+    virtio_blk_status[request] = 0xFF;
+
+    uint16_t head = virtio_blk_state.descriptor_used;
+    virtio_blk_descriptor_add(virtio_blk_physical(&virtio_blk_header[request]), sizeof(struct VirtioBlkRequestHeader), VIRTQ_DESC_F_NEXT);
+    return head;
+}
+
+// Menutup chain dengan descriptor status lalu menaruh head chain di available ring (belum di-notify)
+static void virtio_blk_request_end(uint16_t head)
+{
+    uint8_t request = virtio_blk_state.request_used++;
+    virtio_blk_descriptor_add(virtio_blk_physical(&virtio_blk_status[request]), 1, VIRTQ_DESC_F_WRITE);
+
+    uint16_t index = virtio_blk_state.available->index;
+    virtio_blk_state.available->ring[index % virtio_blk_state.queue_size] = head;
+    __asm__ volatile("" ::: "memory");
+    virtio_blk_state.available->index = index + 1;
+}
+
+/**
+ * Menambahkan descriptor data yang menunjuk memory caller, dipecah pada batas page 4 MiB.
+ * Mengembalikan jumlah blok yang tercakup, bisa lebih kecil dari block_count jika descriptor
+ * (satu disisakan untuk status) atau seg_max habis
+ */
+static uint32_t virtio_blk_append_data(const void *ptr, uint32_t block_count, bool write, uint16_t head)
+{
+    uint32_t virtual_addr = (uint32_t)ptr;
+    uint32_t remaining = block_count * BLOCK_SIZE;
+    uint32_t covered = 0;
+    uint16_t first_entry = virtio_blk_state.descriptor_used;
+    uint16_t flag = VIRTQ_DESC_F_NEXT | (write ? 0 : VIRTQ_DESC_F_WRITE);
+
+    // Descriptor data chain ini dimulai tepat setelah descriptor header
+    while (remaining > 0 && virtio_blk_state.descriptor_used + 1 < virtio_blk_state.queue_size &&
+           virtio_blk_state.descriptor_used - head - 1 < virtio_blk_state.segment_max)
+    {
+        uint32_t physical_addr;
+        if (!paging_virtual_to_physical(&_paging_kernel_page_directory, (void *)virtual_addr, &physical_addr))
+            break;
+
+        uint32_t length = remaining;
+        uint32_t to_page = PAGE_FRAME_SIZE - (virtual_addr & (PAGE_FRAME_SIZE - 1));
+        if (length > to_page)
+            length = to_page;
+
+        virtio_blk_descriptor_add(physical_addr, length, flag);
+        virtual_addr += length;
+        remaining -= length;
+        covered += length;
+    }
+
+    // Panjang data request harus kelipatan BLOCK_SIZE, potong descriptor terakhir region ini jika perlu
+    uint32_t excess = covered % BLOCK_SIZE;
+    covered -= excess;
+    while (excess > 0 && virtio_blk_state.descriptor_used > first_entry)
+    {
+        struct VirtqDescriptor *last = &virtio_blk_state.descriptor[virtio_blk_state.descriptor_used - 1];
+        if (last->length > excess)
+        {
+            last->length -= excess;
+            excess = 0;
+        }
+        else
+        {
+            excess -= last->length;
+            virtio_blk_state.descriptor_used--;
+        }
+    }
+    return covered / BLOCK_SIZE;
+}
+
+// Transfer daftar segment ke / dari LBA berurutan, setiap request satu chain descriptor
+static void virtio_blk_rw(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address, bool write)
+{
+    uint32_t block_count = 0;
+    for (uint32_t i = 0; i < segment_count; i++)
+        block_count += segment[i].block_count;
+
+    uint32_t index = 0;
+    uint32_t offset = 0;
+    while (block_count > 0)
+    {
+        uint16_t head = virtio_blk_request_begin(write ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN, logical_block_address);
+
+        // Setiap segment menjadi descriptor data, berhenti jika descriptor atau seg_max habis
+        uint32_t transferred = 0;
+        uint32_t data_index = index;
+        uint32_t data_offset = offset;
+        while (transferred < block_count)
+        {
+            uint8_t *ptr = block_segment_pointer(segment, &data_index, &data_offset);
+            uint32_t want = segment[data_index].block_count - data_offset;
+            if (want > block_count - transferred)
+                want = block_count - transferred;
+            uint32_t covered = virtio_blk_append_data(ptr, want, write, head);
+            transferred += covered;
+            if (covered < want)
+                break;
+            data_offset += covered;
+        }
+
+        if (transferred == 0)
+        {
+            virtio_blk_state.descriptor_used = head;
+            // Descriptor habis sebelum satu blok utuh tercakup, chain lain diselesaikan lalu dicoba lagi
+            if (virtio_blk_state.request_used > 0)
+            {
+                virtio_blk_complete();
+                continue;
+            }
+            // Memory caller tidak ter-mapping di page directory kernel, transfer dibatalkan
+            break;
+        }
+        virtio_blk_request_end(head);
+
+        block_segment_advance(segment, &index, &offset, transferred);
+        logical_block_address += transferred;
+        block_count -= transferred;
+    }
+
+    // Di luar batch, caller boleh langsung memakai / menimpa memory segment
+    if (!virtio_blk_state.batch)
+        virtio_blk_complete();
+}
+
+static void virtio_blk_read(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    virtio_blk_rw(segment, segment_count, logical_block_address, false);
+}
+
+static void virtio_blk_write(const struct BlockSegment *segment, uint32_t segment_count, uint32_t logical_block_address)
+{
+    virtio_blk_rw(segment, segment_count, logical_block_address, true);
+}
+
+static void virtio_blk_flush(void)
+{
+    // Tanpa VIRTIO_BLK_F_FLUSH device bersifat write-through, cukup menunggu request yang ada
+    if (virtio_blk_state.flush)
+        virtio_blk_request_end(virtio_blk_request_begin(VIRTIO_BLK_T_FLUSH, 0));
+    virtio_blk_complete();
+}
+
+static void virtio_blk_batch_begin(void)
+{
+    virtio_blk_state.batch = true;
+}
+
+static void virtio_blk_batch_end(void)
+{
+    virtio_blk_state.batch = false;
+    virtio_blk_complete();
+}
+
+static void virtio_blk_irq_activate(void)
+{
+    virtio_blk_state.irq_received = false;
+    virtio_blk_state.irq_enabled = true;
+}
+
+static void virtio_blk_isr(void)
+{
+    // Membaca ISR status meng-ACK interrupt INTx device
+    in(virtio_blk_state.io_base + VIRTIO_REGISTER_ISR_STATUS);
+    virtio_blk_state.irq_received = true;
+    pic_ack(virtio_blk_state.irq);
+}
+
+bool virtio_blk_initialize(struct BlockDevice *device)
+{
+    struct PCIDevice controller;
+    if (!pci_find_device_by_id(VIRTIO_VENDOR_ID, VIRTIO_BLK_DEVICE_ID_LEGACY, &controller))
+        return false;
+
+    uint32_t bar0 = pci_read_bar(&controller, 0);
+    if (!(bar0 & PCI_BAR_IO_SPACE))
+        return false;
+
+    pci_enable_command(&controller, PCI_COMMAND_IO_SPACE | PCI_COMMAND_BUS_MASTER);
+    uint16_t io_base = bar0 & PCI_BAR_IO_MASK;
+    virtio_blk_state.io_base = io_base;
+
+    // Reset, lalu ACKNOWLEDGE & DRIVER sebelum negosiasi feature
+    out(io_base + VIRTIO_REGISTER_DEVICE_STATUS, 0);
+    out(io_base + VIRTIO_REGISTER_DEVICE_STATUS, VIRTIO_STATUS_ACKNOWLEDGE);
+    out(io_base + VIRTIO_REGISTER_DEVICE_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+    uint32_t feature = in32(io_base + VIRTIO_REGISTER_DEVICE_FEATURES) & (VIRTIO_BLK_F_SEG_MAX | VIRTIO_BLK_F_FLUSH);
+    out32(io_base + VIRTIO_REGISTER_GUEST_FEATURES, feature);
+
+    // Legacy device menentukan ukuran queue sendiri, queue lebih besar dari memory driver ditolak
+    out16(io_base + VIRTIO_REGISTER_QUEUE_SELECT, 0);
+    uint16_t queue_size = in16(io_base + VIRTIO_REGISTER_QUEUE_SIZE);
+    if (queue_size < 3 || queue_size > VIRTQ_MAX_SIZE)
+    {
+        out(io_base + VIRTIO_REGISTER_DEVICE_STATUS, VIRTIO_STATUS_FAILED);
+        return false;
+    }
+
+    memset(virtio_blk_queue, 0, sizeof(virtio_blk_queue));
+    virtio_blk_state.queue_size = queue_size;
+    virtio_blk_state.descriptor = (struct VirtqDescriptor *)virtio_blk_queue;
+    virtio_blk_state.available = (struct VirtqAvailable *)(virtio_blk_queue + 16 * queue_size);
+    virtio_blk_state.used = (struct VirtqUsed *)(virtio_blk_queue + VIRTQ_ALIGN_UP(16 * queue_size + 6 + 2 * queue_size));
+    out32(io_base + VIRTIO_REGISTER_QUEUE_ADDRESS, virtio_blk_physical(virtio_blk_queue) / VIRTQ_ALIGN);
+
+    // Header & status memakai dua descriptor, sisanya boleh untuk data
+    virtio_blk_state.segment_max = queue_size - 2;
+    if (feature & VIRTIO_BLK_F_SEG_MAX)
+    {
+        uint32_t segment_max = in32(io_base + VIRTIO_REGISTER_CONFIG + VIRTIO_BLK_CONFIG_SEG_MAX);
+        if (segment_max > 0 && segment_max < virtio_blk_state.segment_max)
+            virtio_blk_state.segment_max = segment_max;
+    }
+    virtio_blk_state.flush = feature & VIRTIO_BLK_F_FLUSH;
+    // Capacity 64-bit dalam sektor 512 byte, LBA kernel 32-bit
+    virtio_blk_state.block_count = in32(io_base + VIRTIO_REGISTER_CONFIG + VIRTIO_BLK_CONFIG_CAPACITY);
+    if (in32(io_base + VIRTIO_REGISTER_CONFIG + VIRTIO_BLK_CONFIG_CAPACITY + 4) != 0)
+        virtio_blk_state.block_count = 0xFFFFFFFF;
+    virtio_blk_state.irq = controller.interrupt_line < 16 ? controller.interrupt_line : BLOCK_DEVICE_IRQ_NONE;
+
+    out(io_base + VIRTIO_REGISTER_DEVICE_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER | VIRTIO_STATUS_DRIVER_OK);
+
+    device->read = virtio_blk_read;
+    device->write = virtio_blk_write;
+    device->flush = virtio_blk_flush;
+    device->batch_begin = virtio_blk_batch_begin;
+    device->batch_end = virtio_blk_batch_end;
+    device->irq_activate = virtio_blk_irq_activate;
+    device->isr = virtio_blk_isr;
+    device->irq = virtio_blk_state.irq;
+    device->block_count = virtio_blk_state.block_count;
+    return true;
+}